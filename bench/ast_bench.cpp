@@ -0,0 +1,143 @@
+// Compares traversing the flat AST against the pointer-tree layout it
+// replaced, where every node owned a string discriminator and a vector of
+// heap-allocated children.
+//
+// Usage: ast_bench [functions] [iterations]
+
+#include "ast.hpp"
+#include "lexer.hpp"
+#include "parser.hpp"
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct TreeNode {
+  ast::NodeType type;
+  std::string content;
+  std::vector<TreeNode *> children;
+};
+
+std::string generate(int functions) {
+  std::stringstream src;
+  for (int f = 0; f < functions; f++) {
+    src << "fn func" << f << "(a: i32, b: i32) -> i32 {\n";
+    for (int l = 0; l < 16; l++) {
+      src << "  let x" << l << " = (a + b * " << l + 1 << ") - a / (b - "
+          << l << ") * -(" << l << " + a);\n";
+    }
+    src << "  ret x15;\n}\n";
+  }
+  return src.str();
+}
+
+TreeNode *build_tree(const ast::Ast &ast, ast::NodeId id,
+                     std::vector<std::unique_ptr<TreeNode>> &storage) {
+  storage.push_back(std::make_unique<TreeNode>());
+  TreeNode *node = storage.back().get();
+  node->type = ast.kind(id);
+  node->content = std::string(ast.label(id));
+  for (auto child : ast.children(id)) {
+    node->children.push_back(build_tree(ast, child, storage));
+  }
+  return node;
+}
+
+// Both walks do the same work: dispatch on the operator of every expression
+// node, as type checking and code generation do.
+uint64_t walk_tree(const TreeNode *node) {
+  uint64_t sum = 0;
+  if (node->type == ast::BinaryExpr) {
+    if (node->content == "+") {
+      sum += 1;
+    } else if (node->content == "-") {
+      sum += 2;
+    } else if (node->content == "*") {
+      sum += 3;
+    } else if (node->content == "/") {
+      sum += 4;
+    } else if (node->content == "=") {
+      sum += 5;
+    }
+  }
+  for (auto child : node->children) {
+    sum += walk_tree(child);
+  }
+  return sum;
+}
+
+uint64_t walk_flat(const ast::Ast &ast, ast::NodeId id) {
+  uint64_t sum = 0;
+  if (ast.kind(id) == ast::BinaryExpr) {
+    sum += ast.op(id);
+  }
+  for (auto child : ast.children(id)) {
+    sum += walk_flat(ast, child);
+  }
+  return sum;
+}
+
+// Passes that do not care about structure can scan the arrays directly.
+uint64_t scan_flat(const ast::Ast &ast) {
+  uint64_t sum = 0;
+  for (size_t id = 0; id < ast.size(); id++) {
+    if (ast.kinds[id] == ast::BinaryExpr) {
+      sum += ast.ops[id];
+    }
+  }
+  return sum;
+}
+
+template <typename F> double time_ns(int iterations, uint64_t &result, F f) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++) {
+    result += f();
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count() /
+         iterations;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  int functions = argc > 1 ? std::atoi(argv[1]) : 2000;
+  int iterations = argc > 2 ? std::atoi(argv[2]) : 20;
+
+  std::string source = generate(functions);
+  Interner interner;
+  tokenizer::Lexer lexer(source, interner);
+  ast::Parser parser(lexer.tokens, interner);
+  const ast::Ast &ast = parser.ast;
+  std::vector<std::unique_ptr<TreeNode>> storage;
+  TreeNode *tree = build_tree(ast, ast.root, storage);
+
+  uint64_t tree_result = 0, flat_result = 0, scan_result = 0;
+  double tree_ns =
+      time_ns(iterations, tree_result, [&] { return walk_tree(tree); });
+  double flat_ns = time_ns(iterations, flat_result,
+                           [&] { return walk_flat(ast, ast.root); });
+  double scan_ns =
+      time_ns(iterations, scan_result, [&] { return scan_flat(ast); });
+
+  if (tree_result != flat_result || tree_result != scan_result) {
+    std::cerr << "traversals disagree" << std::endl;
+    return 1;
+  }
+
+  double nodes = ast.size();
+  std::cout << "nodes:          " << ast.size() << std::endl;
+  std::cout << "pointer tree:   " << tree_ns / nodes << " ns/node"
+            << std::endl;
+  std::cout << "flat recursive: " << flat_ns / nodes << " ns/node ("
+            << tree_ns / flat_ns << "x)" << std::endl;
+  std::cout << "flat scan:      " << scan_ns / nodes << " ns/node ("
+            << tree_ns / scan_ns << "x)" << std::endl;
+  return 0;
+}
@@ -0,0 +1,165 @@
+// Front end and back end throughput on synthetic programs of different
+// shapes. Lexing is reported in tokens/s, parsing and type checking in AST
+// nodes/s and code generation (-O0, one thread) in functions/s. Results are
+// compared with a baseline recorded on the same machine by
+// `--update-baseline` and the exit code is 1 when a metric falls more than
+// the tolerance below it. Without a baseline the results are only printed.
+//
+// Usage: brom_bench [--baseline=<file>] [--update-baseline]
+//                   [--tolerance=<fraction>] [--iterations=<n>]
+
+#include "checker.hpp"
+#include "compiler.hpp"
+#include "generator.hpp"
+#include "interner.hpp"
+#include "lexer.hpp"
+#include "options.hpp"
+#include "parser.hpp"
+#include "thread_pool.hpp"
+#include <llvm/Support/FileSystem.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+const Shape shapes[] = {
+    // name          functions  lets  depth  params
+    {"functions", 4000, 4, 2, 2},
+    {"let_chain", 1, 20000, 2, 2},
+    {"nested", 4, 8, 1000, 4},
+    {"params", 400, 4, 2, 64},
+};
+
+// Best of `iterations` runs, in seconds.
+template <typename F> double best_of(int iterations, F f) {
+  double best = 1e30;
+  for (int i = 0; i < iterations; i++) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    best = std::min(best, std::chrono::duration<double>(end - start).count());
+  }
+  return best;
+}
+
+// Empty when `path` does not exist.
+std::map<std::string, double> read_baseline(const std::string &path) {
+  std::map<std::string, double> baseline;
+  std::ifstream file(path);
+  std::string metric;
+  double value;
+  while (file >> metric >> value) {
+    baseline[metric] = value;
+  }
+  return baseline;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  std::string baseline_path = BROM_BENCH_BASELINE;
+  bool update = false;
+  double tolerance = 0.25;
+  int iterations = 5;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg.rfind("--baseline=", 0) == 0) {
+      baseline_path = arg.substr(11);
+    } else if (arg == "--update-baseline") {
+      update = true;
+    } else if (arg.rfind("--tolerance=", 0) == 0) {
+      tolerance = std::atof(arg.c_str() + 12);
+    } else if (arg.rfind("--iterations=", 0) == 0) {
+      iterations = std::atoi(arg.c_str() + 13);
+    } else {
+      std::cerr << "Usage: brom_bench [--baseline=<file>] [--update-baseline] "
+                   "[--tolerance=<fraction>] [--iterations=<n>]"
+                << std::endl;
+      return 1;
+    }
+  }
+
+  int fd;
+  llvm::SmallString<128> output;
+  llvm::sys::fs::createTemporaryFile("brom_bench", "o", fd, output);
+  llvm::sys::fs::closeFile(fd);
+  CompileOptions options;
+  options.output = output.str().str();
+  ThreadPool pool(0);
+
+  std::vector<std::pair<std::string, double>> results;
+  for (auto &shape : shapes) {
+    std::string source = generate(shape);
+    Interner interner;
+    tokenizer::Lexer lexer(source, interner);
+    ast::Parser parser(lexer.tokens, interner);
+    ast::TypeChecker(parser.ast).check();
+
+    double lex = best_of(iterations, [&] {
+      Interner interner;
+      tokenizer::Lexer lexer(source, interner);
+    });
+    double parse = best_of(iterations, [&] {
+      ast::Parser parser(lexer.tokens, interner);
+    });
+    double check = best_of(iterations, [&] {
+      ast::TypeChecker checker(parser.ast);
+      checker.check();
+    });
+    double compile = best_of(std::max(1, iterations / 2), [&] {
+      Compiler compiler(parser.ast, options, pool);
+      compiler.compile();
+    });
+
+    std::string prefix = std::string(shape.name) + ".";
+    results.push_back({prefix + "lex_tokens_per_s", lexer.tokens.size() / lex});
+    results.push_back({prefix + "parse_nodes_per_s", parser.ast.size() / parse});
+    results.push_back({prefix + "check_nodes_per_s", parser.ast.size() / check});
+    results.push_back(
+        {prefix + "compile_functions_per_s", shape.functions / compile});
+  }
+  llvm::sys::fs::remove(output);
+
+  if (update) {
+    std::ofstream file(baseline_path);
+    for (auto &[metric, value] : results) {
+      file << metric << " " << std::setprecision(6) << value << "\n";
+    }
+    std::cout << "Wrote " << baseline_path << std::endl;
+    return 0;
+  }
+
+  auto baseline = read_baseline(baseline_path);
+  if (baseline.empty()) {
+    std::cout << "No baseline at " << baseline_path
+              << ", run with --update-baseline to record one" << std::endl;
+  }
+  bool regressed = false;
+  std::cout << std::left << std::setw(36) << "metric" << std::right
+            << std::setw(14) << "value" << std::setw(14) << "baseline"
+            << std::setw(9) << "ratio" << std::endl;
+  for (auto &[metric, value] : results) {
+    std::cout << std::left << std::setw(36) << metric << std::right
+              << std::setw(14) << std::setprecision(4) << value;
+    auto expected = baseline.find(metric);
+    if (expected == baseline.end()) {
+      std::cout << std::setw(14) << "-" << std::endl;
+      continue;
+    }
+    double ratio = value / expected->second;
+    bool slow = ratio < 1 - tolerance;
+    regressed |= slow;
+    std::cout << std::setw(14) << expected->second << std::setw(9)
+              << std::setprecision(3) << ratio << (slow ? "  REGRESSED" : "")
+              << std::endl;
+  }
+  return regressed ? 1 : 0;
+}
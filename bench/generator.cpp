@@ -0,0 +1,46 @@
+#include "generator.hpp"
+
+namespace {
+
+const char *operators[] = {" + ", " - ", " * ", " + "};
+
+// (((prev + p0) - p1) * p2 ...), `depth` groups around the previous value.
+void expression(std::string &src, const Shape &shape, int let) {
+  for (int d = 0; d < shape.depth; d++)
+    src += "(";
+  src += let == 0 ? "p0" : "v" + std::to_string(let - 1);
+  for (int d = 0; d < shape.depth; d++) {
+    src += operators[d % 4];
+    src += d % 3 == 2 ? std::to_string(d) : "p" + std::to_string(d % shape.params);
+    src += ")";
+  }
+}
+
+} // namespace
+
+std::string generate(const Shape &shape) {
+  std::string src;
+  for (int f = 0; f < shape.functions; f++) {
+    src += "fn func" + std::to_string(f) + "(";
+    for (int p = 0; p < shape.params; p++) {
+      src += (p ? ", p" : "p") + std::to_string(p) + ": i32";
+    }
+    src += ") -> i32 {\n";
+    for (int l = 0; l < shape.lets; l++) {
+      src += "  let v" + std::to_string(l) + " = ";
+      expression(src, shape, l);
+      src += ";\n";
+    }
+    std::string last = shape.lets ? "v" + std::to_string(shape.lets - 1) : "p0";
+    if (f == 0) {
+      src += "  ret " + last + ";\n}\n";
+      continue;
+    }
+    src += "  ret func" + std::to_string(f - 1) + "(" + last;
+    for (int p = 1; p < shape.params; p++) {
+      src += ", p" + std::to_string(p);
+    }
+    src += ");\n}\n";
+  }
+  return src;
+}
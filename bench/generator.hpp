@@ -0,0 +1,20 @@
+#ifndef GENERATOR_H_
+#define GENERATOR_H_
+
+#include <string>
+
+// Shape of a synthetic brom program. Every function takes `params` i32
+// arguments and has a chain of `lets` bindings, each reading the previous
+// one through an expression nested `depth` groups deep. Every function but
+// the first ends by calling its predecessor with all of its parameters.
+struct Shape {
+  const char *name;
+  int functions;
+  int lets;
+  int depth;
+  int params;
+};
+
+std::string generate(const Shape &shape);
+
+#endif // GENERATOR_H_
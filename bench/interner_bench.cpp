@@ -0,0 +1,110 @@
+// Compares carrying identifiers as interned symbols against copying their
+// text at every stage, on identifier-heavy code.
+//
+// Usage: interner_bench [functions] [iterations]
+
+#include "interner.hpp"
+#include "lexer.hpp"
+#include "symbols.hpp"
+#include "token.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string generate(int functions) {
+  std::stringstream src;
+  for (int f = 0; f < functions; f++) {
+    src << "fn computeSomethingUseful" << f
+        << "(firstArgumentValue: i64, secondArgumentValue: i64) -> i64 {\n";
+    src << "  let intermediateResultNumber0 = firstArgumentValue;\n";
+    for (int l = 1; l < 24; l++) {
+      src << "  let intermediateResultNumber" << l
+          << " = intermediateResultNumber" << l - 1
+          << " * secondArgumentValue + firstArgumentValue;\n";
+    }
+    src << "  ret intermediateResultNumber23;\n}\n";
+  }
+  return src.str();
+}
+
+template <typename F> double time_ns(int iterations, F f) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++) {
+    f();
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count() /
+         iterations;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  int functions = argc > 1 ? std::atoi(argv[1]) : 2000;
+  int iterations = argc > 2 ? std::atoi(argv[2]) : 10;
+
+  std::string source = generate(functions);
+  Interner interner;
+  tokenizer::Lexer lexer(source, interner);
+
+  std::vector<std::string> copies;
+  std::vector<Symbol> symbols;
+  size_t copied_bytes = 0;
+  for (auto &token : lexer.tokens) {
+    if (!token.is(tokenizer::TokenType::Identifier))
+      continue;
+    copies.emplace_back(token.lexeme);
+    symbols.push_back(token.symbol);
+    copied_bytes += sizeof(std::string);
+    if (token.lexeme.size() >= sizeof(std::string) - 1)
+      copied_bytes += token.lexeme.size() + 1;
+  }
+
+  // One copy of every occurrence per stage that used to hold it: lexeme,
+  // node content and symbol table entry.
+  copied_bytes *= 3;
+  size_t interned_bytes = interner.bytes() +
+                          interner.size() * sizeof(std::string_view) +
+                          symbols.size() * sizeof(Symbol) * 3;
+
+  // Bind every identifier, then resolve every occurrence, the way the type
+  // checker and code generator do.
+  size_t found = 0;
+  double string_ns = time_ns(iterations, [&] {
+    SymbolTable<std::string, int> table;
+    for (auto &name : copies) {
+      if (auto value = table.lookup(name))
+        found += *value;
+      else
+        table.insert(name, 1);
+    }
+  });
+  double symbol_ns = time_ns(iterations, [&] {
+    SymbolTable<Symbol, int> table;
+    for (auto symbol : symbols) {
+      if (auto value = table.lookup(symbol))
+        found += *value;
+      else
+        table.insert(symbol, 1);
+    }
+  });
+
+  std::cout << "identifier occurrences: " << symbols.size() << std::endl;
+  std::cout << "distinct symbols:       " << interner.size() << std::endl;
+  std::cout << "copied text:            " << copied_bytes / 1024 << " KiB"
+            << std::endl;
+  std::cout << "interned:               " << interned_bytes / 1024 << " KiB ("
+            << double(copied_bytes) / interned_bytes << "x smaller)"
+            << std::endl;
+  std::cout << "string lookups:         " << string_ns / symbols.size()
+            << " ns/identifier" << std::endl;
+  std::cout << "symbol lookups:         " << symbol_ns / symbols.size()
+            << " ns/identifier (" << string_ns / symbol_ns << "x)"
+            << std::endl;
+  return found == 0;
+}
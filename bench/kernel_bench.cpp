@@ -0,0 +1,78 @@
+// Runs the kernels in kernels/kernels.br, compiled by brom, next to their C
+// versions in kernels/kernels.c, compiled by the C compiler at the same
+// optimization level, and reports ns per call and the brom/C ratio. The
+// kernels live in their own objects, so neither side is inlined into the
+// loop and both pay the same call overhead.
+//
+// Usage: kernel_bench [calls]
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+extern "C" {
+int32_t brompoly(int32_t x);
+int64_t brommix(int64_t a, int64_t b);
+int32_t bromdivs(int32_t a, int32_t b);
+int32_t bromchain(int32_t x, int32_t y);
+
+int32_t cpoly(int32_t x);
+int64_t cmix(int64_t a, int64_t b);
+int32_t cdivs(int32_t a, int32_t b);
+int32_t cchain(int32_t x, int32_t y);
+}
+
+namespace {
+
+volatile int64_t sink;
+
+// Nanoseconds per call of `kernel(i)` for i in [0, calls), and the sum of
+// the results so both versions can be checked against each other.
+template <typename F> double ns_per_call(long calls, int64_t &sum, F kernel) {
+  int64_t total = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (long i = 0; i < calls; i++) {
+    total += kernel(static_cast<int32_t>(i));
+  }
+  auto end = std::chrono::steady_clock::now();
+  sink = total;
+  sum = total;
+  return std::chrono::duration<double, std::nano>(end - start).count() / calls;
+}
+
+template <typename B, typename C>
+void compare(const char *name, long calls, B brom, C c) {
+  int64_t brom_sum, c_sum;
+  double brom_ns = ns_per_call(calls, brom_sum, brom);
+  double c_ns = ns_per_call(calls, c_sum, c);
+  std::cout << std::left << std::setw(8) << name << std::right << std::fixed
+            << std::setprecision(3) << std::setw(12) << brom_ns
+            << std::setw(12) << c_ns << std::setw(10) << brom_ns / c_ns
+            << (brom_sum != c_sum ? "  results differ" : "") << std::endl;
+}
+
+// Divisors stay small and positive.
+int32_t divisor(int32_t i) { return (i & 1023) + 1; }
+
+} // namespace
+
+int main(int argc, char **argv) {
+  long calls = argc > 1 ? std::atol(argv[1]) : 50000000;
+
+  std::cout << std::left << std::setw(8) << "kernel" << std::right
+            << std::setw(12) << "brom ns" << std::setw(12) << "C ns"
+            << std::setw(10) << "brom/C" << std::endl;
+  compare("poly", calls, brompoly, cpoly);
+  compare(
+      "mix", calls, [](int32_t i) { return brommix(i, i ^ 0x5bd1e995); },
+      [](int32_t i) { return cmix(i, i ^ 0x5bd1e995); });
+  compare(
+      "divs", calls, [](int32_t i) { return bromdivs(i, divisor(i)); },
+      [](int32_t i) { return cdivs(i, divisor(i)); });
+  compare(
+      "chain", calls, [](int32_t i) { return bromchain(i, i >> 3); },
+      [](int32_t i) { return cchain(i, i >> 3); });
+  return 0;
+}
@@ -0,0 +1,42 @@
+/* C versions of kernels.br, written to match their arithmetic exactly.
+   Built with -fwrapv so signed overflow wraps, as it does in brom. */
+
+#include <stdint.h>
+
+int32_t cpoly(int32_t x) {
+  return ((((((((3 * x + 7) * x - 11) * x + 13) * x - 17) * x + 19) * x -
+            23) * x + 29) * x - 31);
+}
+
+int64_t cmix(int64_t a, int64_t b) {
+  int64_t h = a * 1103515245ll + b;
+  int64_t i = h * 69069ll - a;
+  int64_t j = (i + h) * (i - b) + 1013904223ll;
+  int64_t k = j * j - i * 3ll;
+  return k + j / 7ll;
+}
+
+int32_t cdivs(int32_t a, int32_t b) {
+  int32_t q = a / b;
+  int32_t r = a - q * b;
+  int32_t s = (a + r) / (b + 3);
+  return q + r * 5 + s / 9;
+}
+
+static int32_t cstep1(int32_t x, int32_t y) { return x * 3 + y; }
+
+static int32_t cstep2(int32_t x, int32_t y) {
+  return cstep1(x - y, y * 2) + 1;
+}
+
+static int32_t cstep3(int32_t x, int32_t y) {
+  return cstep2(x + 5, y - x) * 7;
+}
+
+static int32_t cstep4(int32_t x, int32_t y) {
+  return cstep3(y, x) - cstep1(x, y);
+}
+
+int32_t cchain(int32_t x, int32_t y) {
+  return cstep4(cstep4(x, y), cstep2(y, x));
+}
@@ -0,0 +1,108 @@
+// Measures lexer throughput on a large generated source, and the vectorized
+// run scanning against its scalar fallback.
+//
+// Usage: lexer_bench [megabytes] [iterations]
+
+#include "interner.hpp"
+#include "lexer.hpp"
+#include "scan.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+namespace {
+
+std::string generate(size_t bytes) {
+  std::stringstream src;
+  for (int f = 0; size_t(src.tellp()) < bytes; f++) {
+    src << "fn someLongFunctionName" << f
+        << "(firstArgument: i64, secondArgument: i64) -> i64 {\n";
+    for (int l = 0; l < 16; l++) {
+      src << "        let temporaryValue" << l << " = firstArgument * "
+          << 1234567 + l << " + (secondArgument - 98765432" << l << ");\n";
+    }
+    src << "        ret temporaryValue15;\n}\n\n";
+  }
+  return src.str();
+}
+
+// Walks the source the way the lexer does, counting runs and their lengths.
+template <typename Space, typename Digits, typename Alnum>
+size_t walk(const std::string &source, Space space, Digits digits,
+            Alnum alnum) {
+  const char *s = source.data();
+  const char *end = s + source.size();
+  size_t sum = 0;
+  int lines = 0;
+  while (s < end) {
+    const char *start = s;
+    if (tokenizer::scan::is(*s, tokenizer::scan::Space)) {
+      s = space(s, end, lines);
+    } else if (tokenizer::scan::is(*s, tokenizer::scan::Digit)) {
+      s = digits(s + 1, end);
+    } else if (tokenizer::scan::is(*s, tokenizer::scan::Alpha)) {
+      s = alnum(s + 1, end);
+    } else {
+      s++;
+    }
+    sum = sum * 31 + (s - start);
+  }
+  return sum + lines;
+}
+
+template <typename F> double seconds(int iterations, F f) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++) {
+    f();
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double>(end - start).count() / iterations;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  using namespace tokenizer;
+  size_t megabytes = argc > 1 ? std::atoi(argv[1]) : 32;
+  int iterations = argc > 2 ? std::atoi(argv[2]) : 5;
+
+  std::string source = generate(megabytes << 20);
+  double gb = source.size() / 1e9;
+
+  size_t vector_sum = 0, scalar_sum = 0, tokens = 0;
+  double vector_s = seconds(iterations, [&] {
+    vector_sum = walk(source, scan::skip_space, scan::skip_digits,
+                      scan::skip_alnum);
+  });
+  double scalar_s = seconds(iterations, [&] {
+    scalar_sum = walk(
+        source, scan::skip_space_scalar,
+        [](const char *s, const char *end) {
+          return scan::skip_scalar(s, end, scan::Digit);
+        },
+        [](const char *s, const char *end) {
+          return scan::skip_scalar(s, end, scan::Digit | scan::Alpha);
+        });
+  });
+  double lexer_s = seconds(iterations, [&] {
+    Interner interner;
+    Lexer lexer(source, interner);
+    tokens = lexer.tokens.size();
+  });
+
+  if (vector_sum != scalar_sum) {
+    std::cerr << "vector and scalar scans disagree" << std::endl;
+    return 1;
+  }
+
+  std::cout << "input:        " << source.size() / (1 << 20) << " MiB, "
+            << tokens << " tokens" << std::endl;
+  std::cout << "scan width:   " << scan::width << " bytes" << std::endl;
+  std::cout << "scalar scan:  " << gb / scalar_s << " GB/s" << std::endl;
+  std::cout << "vector scan:  " << gb / vector_s << " GB/s ("
+            << scalar_s / vector_s << "x)" << std::endl;
+  std::cout << "full lexer:   " << gb / lexer_s << " GB/s" << std::endl;
+  return 0;
+}
@@ -0,0 +1,223 @@
+// Compares the operator precedence parser against the recursive descent
+// chain it replaced (expression -> assignment -> term -> factor -> unary ->
+// primary), which took six nested calls per operand and recursed once per
+// level of parentheses.
+//
+// Usage: parser_bench [iterations]
+
+#include "ast.hpp"
+#include "generator.hpp"
+#include "interner.hpp"
+#include "lexer.hpp"
+#include "parser.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using tokenizer::TokenType;
+
+// The previous parser, trimmed to what the generated programs use and
+// without error reporting.
+class ChainParser {
+public:
+  ChainParser(const std::vector<tokenizer::Token> &tokens,
+              const Interner &interner)
+      : tokens(tokens) {
+    this->ast.interner = &interner;
+    this->ast.reserve(tokens.size());
+    this->ast.root = this->ast.add(ast::Block);
+    std::vector<ast::NodeId> stmts;
+    for (auto stmt = statement(); stmt != ast::NoNode; stmt = statement()) {
+      stmts.push_back(stmt);
+    }
+    this->ast.set_children(this->ast.root, stmts.data(), stmts.size());
+  }
+
+  ast::Ast ast;
+
+private:
+  const tokenizer::Token &peek() const { return this->tokens[this->current]; }
+  bool check(TokenType type) const { return peek().is(type); }
+  bool consume(TokenType type) {
+    if (!check(type))
+      return false;
+    advance();
+    return true;
+  }
+  void advance() {
+    if (this->current + 1 < this->tokens.size())
+      this->current++;
+  }
+  const tokenizer::Token &next() {
+    auto &head = peek();
+    advance();
+    return head;
+  }
+
+  ast::NodeId statement() {
+    if (consume(TokenType::Let)) {
+      auto node = this->ast.add(ast::Let, ast::NoOp, NoSymbol, {expression()});
+      consume(TokenType::SemiColon);
+      return node;
+    } else if (consume(TokenType::Ret)) {
+      auto node = this->ast.add(ast::Ret, ast::NoOp, NoSymbol, {expression()});
+      consume(TokenType::SemiColon);
+      return node;
+    } else if (consume(TokenType::Fn)) {
+      auto identifier = this->ast.add(ast::Identifier, ast::NoOp, next().symbol);
+      consume(TokenType::LParen);
+      auto args = this->ast.add(ast::Arguments);
+      std::vector<ast::NodeId> list;
+      while (check(TokenType::Identifier)) {
+        auto symbol = next().symbol;
+        consume(TokenType::Colon);
+        auto type = this->ast.add(ast::Type);
+        this->ast.types[type] = ast::type_from_keyword(next().keyword);
+        list.push_back(this->ast.add(ast::Argument, ast::NoOp, symbol, {type}));
+        consume(TokenType::Comma);
+      }
+      this->ast.set_children(args, list.data(), list.size());
+      consume(TokenType::RParen);
+      auto type = this->ast.add(ast::Type);
+      if (consume(TokenType::RightArrow)) {
+        this->ast.types[type] = ast::type_from_keyword(next().keyword);
+      }
+      consume(TokenType::LCurly);
+      auto block = this->ast.add(ast::Block);
+      list.clear();
+      for (auto stmt = statement(); stmt != ast::NoNode; stmt = statement()) {
+        list.push_back(stmt);
+      }
+      this->ast.set_children(block, list.data(), list.size());
+      consume(TokenType::RCurly);
+      return this->ast.add(ast::Fn, ast::NoOp, NoSymbol,
+                           {identifier, args, type, block});
+    }
+    return ast::NoNode;
+  }
+
+  ast::NodeId expression() { return assignment(); }
+
+  ast::NodeId assignment() {
+    auto res = term();
+    if (consume(TokenType::Equal)) {
+      auto rhs = term();
+      res = this->ast.add(ast::BinaryExpr, ast::Assign, NoSymbol, {res, rhs});
+    }
+    return res;
+  }
+
+  ast::NodeId term() {
+    auto res = factor();
+    while (check(TokenType::Plus) || check(TokenType::Minus)) {
+      auto op = check(TokenType::Plus) ? ast::Add : ast::Sub;
+      advance();
+      auto rhs = factor();
+      res = this->ast.add(ast::BinaryExpr, op, NoSymbol, {res, rhs});
+    }
+    return res;
+  }
+
+  ast::NodeId factor() {
+    auto res = unary();
+    while (check(TokenType::Star) || check(TokenType::Slash)) {
+      auto op = check(TokenType::Star) ? ast::Mul : ast::Div;
+      advance();
+      auto rhs = unary();
+      res = this->ast.add(ast::BinaryExpr, op, NoSymbol, {res, rhs});
+    }
+    return res;
+  }
+
+  ast::NodeId unary() {
+    if (consume(TokenType::Minus)) {
+      return this->ast.add(ast::UnaryExpr, ast::Negate, NoSymbol, {primary()});
+    }
+    return primary();
+  }
+
+  ast::NodeId primary() {
+    auto &tok = next();
+    if (tok.is(TokenType::I32Literal)) {
+      auto node = this->ast.add(ast::Integer, ast::NoOp, tok.symbol);
+      this->ast.types[node] = ast::I32;
+      return node;
+    } else if (tok.is(TokenType::LParen)) {
+      auto expr = expression();
+      consume(TokenType::RParen);
+      return this->ast.add(ast::Grouping, ast::NoOp, NoSymbol, {expr});
+    }
+    if (!consume(TokenType::LParen)) {
+      return this->ast.add(ast::Identifier, ast::NoOp, tok.symbol);
+    }
+    auto params = this->ast.add(ast::Parameters);
+    std::vector<ast::NodeId> list;
+    if (!check(TokenType::RParen)) {
+      list.push_back(expression());
+      while (consume(TokenType::Comma)) {
+        list.push_back(expression());
+      }
+    }
+    this->ast.set_children(params, list.data(), list.size());
+    consume(TokenType::RParen);
+    return this->ast.add(ast::Call, ast::NoOp, tok.symbol, {params});
+  }
+
+  const std::vector<tokenizer::Token> &tokens;
+  size_t current = 0;
+};
+
+template <typename F> double best_ns(int iterations, F f) {
+  double best = 1e30;
+  for (int i = 0; i < iterations; i++) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    best = std::min(
+        best, std::chrono::duration<double, std::nano>(end - start).count());
+  }
+  return best;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  int iterations = argc > 1 ? std::atoi(argv[1]) : 10;
+
+  const Shape shapes[] = {
+      // name          functions  lets  depth  params
+      {"flat", 2000, 8, 4, 4},
+      {"nested", 20, 8, 400, 4},
+      {"calls", 400, 4, 2, 32},
+  };
+
+  std::cout << "shape     nodes      chain ns/node  precedence ns/node"
+            << std::endl;
+  for (auto &shape : shapes) {
+    std::string source = generate(shape);
+    Interner interner;
+    tokenizer::Lexer lexer(source, interner);
+
+    size_t chain_nodes = 0, nodes = 0;
+    double chain = best_ns(iterations, [&] {
+      ChainParser parser(lexer.tokens, interner);
+      chain_nodes = parser.ast.size();
+    });
+    double precedence = best_ns(iterations, [&] {
+      ast::Parser parser(lexer.tokens, interner);
+      nodes = parser.ast.size();
+    });
+    if (chain_nodes != nodes) {
+      std::cerr << "parsers disagree on " << shape.name << std::endl;
+      return 1;
+    }
+    std::cout << shape.name << "\t  " << nodes << "\t     " << chain / nodes
+              << "\t\t" << precedence / nodes << " ("
+              << chain / precedence << "x)" << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,60 @@
+// Measures type checking on deeply nested expressions. The checker visits
+// every node once, so the time per node should stay flat as depth grows.
+//
+// Usage: typecheck_bench [iterations]
+
+#include "ast.hpp"
+#include "checker.hpp"
+#include "lexer.hpp"
+#include "parser.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+namespace {
+
+// ((((1 + 1) + 1) + 1) ...) and id(id(id(...))), `depth` levels deep.
+std::string generate(int depth) {
+  std::string src = "fn id(a: i32) -> i32 {\n  ret a;\n}\n";
+  src += "fn main() -> i32 {\n  let x = ";
+  for (int i = 0; i < depth; i++)
+    src += "(";
+  src += "1";
+  for (int i = 0; i < depth; i++)
+    src += " + 1)";
+  src += ";\n  let y = ";
+  for (int i = 0; i < depth; i++)
+    src += "id(";
+  src += "x";
+  for (int i = 0; i < depth; i++)
+    src += ")";
+  src += ";\n  ret y;\n}\n";
+  return src;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  int iterations = argc > 1 ? std::atoi(argv[1]) : 50;
+
+  std::cout << "depth    nodes    ns/node" << std::endl;
+  for (int depth = 256; depth <= 4096; depth *= 2) {
+    std::string source = generate(depth);
+    Interner interner;
+    tokenizer::Lexer lexer(source, interner);
+    ast::Parser parser(lexer.tokens, interner);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+      ast::TypeChecker checker(parser.ast);
+      checker.check();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    std::cout << depth << "\t " << parser.ast.size() << "\t  "
+              << ns / iterations / parser.ast.size() << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,59 @@
+#include "arena.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+Arena::Arena(size_t chunk_size) : chunk_size(chunk_size) {}
+
+Arena::~Arena() { release(); }
+
+void *Arena::allocate(size_t size, size_t align) {
+  auto aligned = [&](char *p) {
+    auto addr = reinterpret_cast<uintptr_t>(p);
+    return reinterpret_cast<char *>((addr + align - 1) & ~(align - 1));
+  };
+
+  char *p = aligned(this->cursor);
+  if (!this->cursor || p + size > this->limit) {
+    grow(size + align);
+    p = aligned(this->cursor);
+  }
+
+  this->cursor = p + size;
+  this->used += size;
+  return p;
+}
+
+std::string_view Arena::copy(std::string_view text) {
+  if (text.empty())
+    return std::string_view();
+  char *dest = static_cast<char *>(allocate(text.size(), 1));
+  std::memcpy(dest, text.data(), text.size());
+  return std::string_view(dest, text.size());
+}
+
+void Arena::grow(size_t min_size) {
+  size_t size = std::max(this->chunk_size, min_size + sizeof(Chunk));
+  auto chunk = static_cast<Chunk *>(std::malloc(size));
+  if (!chunk)
+    throw std::bad_alloc();
+  chunk->prev = this->head;
+  chunk->size = size;
+  this->head = chunk;
+  this->cursor = reinterpret_cast<char *>(chunk + 1);
+  this->limit = reinterpret_cast<char *>(chunk) + size;
+  this->reserved += size;
+}
+
+void Arena::release() {
+  while (this->head) {
+    Chunk *prev = this->head->prev;
+    std::free(this->head);
+    this->head = prev;
+  }
+  this->cursor = nullptr;
+  this->limit = nullptr;
+  this->used = 0;
+  this->reserved = 0;
+}
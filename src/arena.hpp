@@ -0,0 +1,45 @@
+#ifndef ARENA_H_
+#define ARENA_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Bump allocator backing the interner's string storage. Memory is handed out
+// from large chunks and only ever released all at once, either through
+// `release()` or when the arena is destroyed, so the views it returns stay
+// valid for the arena's whole lifetime.
+class Arena {
+public:
+  explicit Arena(size_t chunk_size = 64 * 1024);
+  ~Arena();
+  Arena(const Arena &) = delete;
+  Arena &operator=(const Arena &) = delete;
+
+  void *allocate(size_t size, size_t align);
+
+  std::string_view copy(std::string_view text);
+
+  // Frees every chunk at once, invalidating all pointers handed out so far.
+  void release();
+
+  size_t bytes_used() const { return this->used; }
+  size_t bytes_reserved() const { return this->reserved; }
+
+private:
+  struct Chunk {
+    Chunk *prev;
+    size_t size;
+  };
+
+  void grow(size_t min_size);
+
+  size_t chunk_size;
+  Chunk *head = nullptr;
+  char *cursor = nullptr;
+  char *limit = nullptr;
+  size_t used = 0;
+  size_t reserved = 0;
+};
+
+#endif // ARENA_H_
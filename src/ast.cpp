@@ -0,0 +1,179 @@
+#include "ast.hpp"
+#include <ostream>
+#include <string>
+
+namespace ast {
+
+NodeId Ast::add(NodeType kind, Operator op, Symbol symbol,
+                std::initializer_list<NodeId> children) {
+  NodeId id = this->kinds.size();
+  this->kinds.push_back(kind);
+  this->ops.push_back(op);
+  this->types.push_back(Type::Mismatch);
+  this->symbols.push_back(symbol);
+  this->ranges.push_back(ChildRange{0, 0});
+  set_children(id, children.begin(), children.size());
+  return id;
+}
+
+void Ast::set_children(NodeId id, const NodeId *children, size_t count) {
+  this->ranges[id].first = this->child_ids.size();
+  this->ranges[id].count = count;
+  this->child_ids.insert(this->child_ids.end(), children, children + count);
+}
+
+void Ast::reserve(size_t nodes) {
+  this->kinds.reserve(nodes);
+  this->ops.reserve(nodes);
+  this->types.reserve(nodes);
+  this->symbols.reserve(nodes);
+  this->ranges.reserve(nodes);
+  this->child_ids.reserve(nodes);
+}
+
+std::string_view Ast::label(NodeId id) const {
+  switch (kind(id)) {
+  case BinaryExpr:
+  case UnaryExpr:
+    return operator_name(op(id));
+  case Type:
+    return type_name(type(id));
+  case Block:
+    return id == this->root ? "program" : "block";
+  case Let:
+    return "let";
+  case Fn:
+    return exported(id) ? "pub fn" : "fn";
+  case Ret:
+    return "ret";
+  case Grouping:
+    return "group";
+  case Arguments:
+    return "args";
+  case Parameters:
+    return "params";
+  case Invalid:
+    return "invalid";
+  default:
+    return name(id);
+  }
+}
+
+void print_ast(std::ostream &out, const Ast &ast, NodeId root,
+               std::string prefix) {
+  switch (ast.kind(root)) {
+  case Type:
+  case Invalid:
+  case Identifier:
+    out << prefix << "└── " << ast.label(root) << std::endl;
+    break;
+  case Integer:
+  case Float:
+    out << prefix << "├── " << ast.label(root) << std::endl;
+    out << prefix << "|   └── " << type_name(ast.type(root)) << std::endl;
+    break;
+  case BinaryExpr:
+  case Let:
+  case Grouping:
+  case Argument:
+  case Fn:
+  case Arguments:
+  case Block:
+  case Ret:
+  case Call:
+  case UnaryExpr:
+  case Parameters:
+    out << prefix << "├── " << ast.label(root) << std::endl;
+    for (NodeId child : ast.children(root)) {
+      print_ast(out, ast, child, prefix + "|   ");
+    }
+    break;
+  }
+}
+
+const char *type_name(enum Type type) {
+  switch (type) {
+  case Type::U8:
+    return "u8";
+  case Type::U16:
+    return "u16";
+  case Type::U32:
+    return "u32";
+  case Type::U64:
+    return "u64";
+  case Type::I8:
+    return "i8";
+  case Type::I16:
+    return "i16";
+  case Type::I32:
+    return "i32";
+  case Type::I64:
+    return "i64";
+  case Type::F32:
+    return "f32";
+  case Type::F64:
+    return "f64";
+  case Type::Bool:
+    return "bool";
+  case Type::Void:
+    return "void";
+  default:
+    return "mismatch";
+  }
+}
+
+bool is_integer(enum Type type) { return type >= U8 && type <= I64; }
+
+bool is_signed(enum Type type) { return type >= I8 && type <= I64; }
+
+bool is_float(enum Type type) { return type == F32 || type == F64; }
+
+const char *operator_name(Operator op) {
+  switch (op) {
+  case Add:
+    return "+";
+  case Sub:
+  case Negate:
+    return "-";
+  case Mul:
+    return "*";
+  case Div:
+    return "/";
+  case Assign:
+    return "=";
+  case Eq:
+    return "==";
+  case Ne:
+    return "!=";
+  case Lt:
+    return "<";
+  case Le:
+    return "<=";
+  case Gt:
+    return ">";
+  case Ge:
+    return ">=";
+  case BitAnd:
+    return "&";
+  case BitOr:
+    return "|";
+  case BitXor:
+    return "^";
+  case Shl:
+    return "<<";
+  case Shr:
+    return ">>";
+  case And:
+    return "&&";
+  case Or:
+    return "||";
+  case Not:
+    return "!";
+  case BitNot:
+    return "~";
+  default:
+    return "";
+  }
+}
+
+} // namespace ast
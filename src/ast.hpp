@@ -0,0 +1,163 @@
+#ifndef AST_H_
+#define AST_H_
+
+#include "interner.hpp"
+#include "keywords.hpp"
+#include <cstdint>
+#include <initializer_list>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace ast {
+
+enum Type {
+  Mismatch = -1,
+  U8,
+  U16,
+  U32,
+  U64,
+  I8,
+  I16,
+  I32,
+  I64,
+  F32,
+  F64,
+  Bool,
+  Void
+};
+
+enum NodeType {
+  Invalid = -1,
+  BinaryExpr,
+  UnaryExpr,
+  Call,
+  Parameters,
+  Integer,
+  Float,
+  Grouping,
+  Let,
+  Identifier,
+  Fn,
+  Arguments,
+  Argument,
+  Type,
+  Block,
+  Ret,
+};
+
+enum Operator : uint8_t {
+  NoOp,
+  Add,
+  Sub,
+  Mul,
+  Div,
+  Assign,
+  Negate,
+  Eq,
+  Ne,
+  Lt,
+  Le,
+  Gt,
+  Ge,
+  BitAnd,
+  BitOr,
+  BitXor,
+  Shl,
+  Shr,
+  And,
+  Or,
+  Not,
+  BitNot
+};
+
+// Nodes are addressed by their index in the `Ast` arrays.
+using NodeId = uint32_t;
+constexpr NodeId NoNode = UINT32_MAX;
+
+// Children of a node are stored contiguously in `Ast::child_ids`.
+struct ChildRange {
+  uint32_t first;
+  uint32_t count;
+};
+
+struct Children {
+  const NodeId *first;
+  const NodeId *last;
+
+  const NodeId *begin() const { return this->first; }
+  const NodeId *end() const { return this->last; }
+  size_t size() const { return this->last - this->first; }
+  NodeId operator[](size_t i) const { return this->first[i]; }
+};
+
+// Flat AST: every node property lives in its own array, indexed by NodeId.
+// Operators are enums instead of strings, and `types` holds the type named by
+// `Type` nodes and literal suffixes. Identifiers and literals are stored as
+// symbols of the compilation's interner.
+class Ast {
+public:
+  std::vector<NodeType> kinds;
+  std::vector<Operator> ops;
+  std::vector<enum Type> types;
+  std::vector<Symbol> symbols;
+  std::vector<ChildRange> ranges;
+  std::vector<NodeId> child_ids;
+  // `Fn` nodes declared `pub`.
+  std::unordered_set<NodeId> exports;
+  NodeId root = NoNode;
+  const Interner *interner = nullptr;
+
+  NodeId add(NodeType kind, Operator op = NoOp, Symbol symbol = NoSymbol,
+             std::initializer_list<NodeId> children = {});
+  void set_children(NodeId id, const NodeId *children, size_t count);
+  void reserve(size_t nodes);
+
+  NodeType kind(NodeId id) const { return this->kinds[id]; }
+  Operator op(NodeId id) const { return this->ops[id]; }
+  enum Type type(NodeId id) const { return this->types[id]; }
+  Symbol symbol(NodeId id) const { return this->symbols[id]; }
+  bool exported(NodeId id) const { return this->exports.count(id) != 0; }
+  std::string_view name(NodeId id) const {
+    return this->interner->name(this->symbols[id]);
+  }
+  Children children(NodeId id) const {
+    const NodeId *first = this->child_ids.data() + this->ranges[id].first;
+    return Children{first, first + this->ranges[id].count};
+  }
+  NodeId child(NodeId id, uint32_t i) const {
+    return this->child_ids[this->ranges[id].first + i];
+  }
+  size_t size() const { return this->kinds.size(); }
+
+  // Text shown for the node when dumping the tree.
+  std::string_view label(NodeId id) const;
+};
+
+// Dumps the subtree rooted at `root`, one node per line.
+void print_ast(std::ostream &out, const Ast &ast, NodeId root,
+               std::string prefix = "");
+
+// Type names are keywords laid out in the same order as `Type`, so mapping
+// one to the other is a subtraction.
+constexpr enum Type type_from_keyword(tokenizer::Keyword keyword) {
+  if (!tokenizer::is_type(keyword))
+    return Type::Mismatch;
+  return static_cast<enum Type>(static_cast<int>(keyword) -
+                                static_cast<int>(tokenizer::Keyword::U8));
+}
+
+static_assert(type_from_keyword(tokenizer::Keyword::U8) == Type::U8, "");
+static_assert(type_from_keyword(tokenizer::Keyword::I64) == Type::I64, "");
+static_assert(type_from_keyword(tokenizer::Keyword::Void) == Type::Void, "");
+const char *type_name(enum Type type);
+bool is_integer(enum Type type);
+bool is_signed(enum Type type);
+bool is_float(enum Type type);
+const char *operator_name(Operator op);
+
+} // namespace ast
+
+#endif // AST_H_
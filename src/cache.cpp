@@ -0,0 +1,119 @@
+#include "cache.hpp"
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Config/llvm-config.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/SHA1.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <utility>
+
+// Bump when the compiler starts generating different code for the same AST.
+constexpr uint32_t cache_version = 4;
+
+namespace {
+
+template <typename T> void hash_value(llvm::SHA1 &hasher, T value) {
+  hasher.update(llvm::ArrayRef<uint8_t>(
+      reinterpret_cast<const uint8_t *>(&value), sizeof(value)));
+}
+
+void hash_string(llvm::SHA1 &hasher, std::string_view string) {
+  hash_value(hasher, string.size());
+  hasher.update(llvm::StringRef(string.data(), string.size()));
+}
+
+// Exported functions use a different calling convention, so callers depend
+// on the marker too.
+void hash_signature(llvm::SHA1 &hasher, const ast::Ast &ast, ast::NodeId fn) {
+  hash_value(hasher, ast.exported(fn));
+  for (auto arg : ast.children(ast.child(fn, 1))) {
+    hash_value(hasher, ast.type(ast.child(arg, 0)));
+  }
+  hash_value(hasher, ast.type(ast.child(fn, 2)));
+}
+
+// Hashes the subtree in preorder. Child counts keep the encoding
+// unambiguous, and names are hashed as text since symbol ids depend on the
+// rest of the file.
+void hash_node(llvm::SHA1 &hasher, const ast::Ast &ast, ast::NodeId id,
+               const std::unordered_map<Symbol, ast::NodeId> &functions) {
+  hash_value(hasher, ast.kind(id));
+  hash_value(hasher, ast.op(id));
+  hash_value(hasher, ast.type(id));
+  hash_value(hasher, ast.children(id).size());
+  if (ast.symbol(id) != NoSymbol) {
+    hash_string(hasher, ast.name(id));
+  }
+  if (ast.kind(id) == ast::Call) {
+    hash_signature(hasher, ast, functions.at(ast.symbol(id)));
+  }
+  for (auto child : ast.children(id)) {
+    hash_node(hasher, ast, child, functions);
+  }
+}
+
+} // namespace
+
+ObjectCache::ObjectCache(std::string directory)
+    : directory(std::move(directory)) {
+  if (auto ec = llvm::sys::fs::create_directories(this->directory)) {
+    llvm::errs() << "Could not create cache directory " << this->directory
+                 << ": " << ec.message() << "\n";
+    exit(1);
+  }
+}
+
+std::string
+ObjectCache::key(const ast::Ast &ast, ast::NodeId fn,
+                 const std::unordered_map<Symbol, ast::NodeId> &functions,
+                 const Target &target, const CompileOptions &options) const {
+  llvm::SHA1 hasher;
+  hash_value(hasher, cache_version);
+  hash_string(hasher, LLVM_VERSION_STRING);
+  hash_string(hasher, target.triple);
+  hash_string(hasher, target.cpu);
+  hash_string(hasher, target.features);
+  hash_value(hasher, options.opt_level);
+  hash_value(hasher, options.overflow);
+  hash_value(hasher, options.fast_math);
+  // Whether `fn` itself is exported decides its calling convention.
+  hash_value(hasher, ast.exported(fn));
+  hash_node(hasher, ast, fn, functions);
+  return llvm::toHex(hasher.final(), true);
+}
+
+std::string ObjectCache::path(const std::string &key) const {
+  llvm::SmallString<128> path(this->directory);
+  llvm::sys::path::append(path, key + ".o");
+  return path.str().str();
+}
+
+std::string ObjectCache::lookup(const std::string &key) const {
+  auto path = this->path(key);
+  return llvm::sys::fs::exists(path) ? path : std::string();
+}
+
+std::string ObjectCache::store(const std::string &key,
+                               llvm::ArrayRef<char> object) const {
+  auto path = this->path(key);
+  int fd;
+  llvm::SmallString<128> temporary;
+  if (auto ec = llvm::sys::fs::createUniqueFile(path + ".%%%%%%.tmp", fd,
+                                                temporary)) {
+    llvm::errs() << "Could not write to cache: " << ec.message() << "\n";
+    exit(1);
+  }
+  {
+    llvm::raw_fd_ostream dest(fd, true);
+    dest.write(object.data(), object.size());
+  }
+  if (auto ec = llvm::sys::fs::rename(temporary, path)) {
+    llvm::errs() << "Could not write to cache: " << ec.message() << "\n";
+    exit(1);
+  }
+  return path;
+}
@@ -0,0 +1,39 @@
+#ifndef CACHE_H_
+#define CACHE_H_
+
+#include "ast.hpp"
+#include "options.hpp"
+#include "target.hpp"
+#include <llvm/ADT/ArrayRef.h>
+#include <string>
+#include <unordered_map>
+
+// On-disk store of object files that each hold a single function. Objects
+// are addressed by a hash of everything that can change their code, so an
+// entry never has to be invalidated: an edited function simply gets a new
+// key and the old object is no longer looked up.
+class ObjectCache {
+public:
+  // Creates `directory` if it does not exist.
+  explicit ObjectCache(std::string directory);
+
+  // Hash of the function's AST, the signatures of the functions it calls,
+  // the code generation flags and the target.
+  std::string key(const ast::Ast &ast, ast::NodeId fn,
+                  const std::unordered_map<Symbol, ast::NodeId> &functions,
+                  const Target &target, const CompileOptions &options) const;
+
+  // Path of the object stored under `key`, or an empty string.
+  std::string lookup(const std::string &key) const;
+  // Stores `object` under `key` and returns its path. Entries are written to
+  // a temporary file and renamed, so concurrent compilers never see a partial
+  // object.
+  std::string store(const std::string &key, llvm::ArrayRef<char> object) const;
+
+private:
+  std::string path(const std::string &key) const;
+
+  std::string directory;
+};
+
+#endif // CACHE_H_
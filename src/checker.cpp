@@ -0,0 +1,192 @@
+#include "checker.hpp"
+#include "source.hpp"
+#include <string>
+
+namespace ast {
+
+TypeChecker::TypeChecker(Ast &ast) : ast(ast) {}
+
+void TypeChecker::check() {
+  for (auto stmt : this->ast.children(this->ast.root)) {
+    if (this->ast.kind(stmt) != Fn) {
+      type_error("Only functions can be declared at the top level, found `" +
+                 std::string(this->ast.label(stmt)) + "`");
+    }
+    check_statement(stmt);
+  }
+}
+
+void TypeChecker::type_error(std::string message) {
+  throw CompileError("Type error: " + message);
+}
+
+void TypeChecker::check_statement(NodeId stmt) {
+  switch (this->ast.kind(stmt)) {
+  case Fn:
+    check_function(stmt);
+    break;
+  case Let: {
+    auto assignment = this->ast.child(stmt, 0);
+    auto identifier = this->ast.child(assignment, 0);
+    auto type = check_expr(this->ast.child(assignment, 1));
+
+    this->variables.insert(this->ast.symbol(identifier), type);
+
+    this->ast.types[identifier] = type;
+    this->ast.types[assignment] = type;
+    this->ast.types[stmt] = type;
+  } break;
+  case Ret: {
+    auto type = check_expr(this->ast.child(stmt, 0));
+    if (type != this->return_type) {
+      type_error(std::string("Returning `") + type_name(type) +
+                 "` from a function returning `" +
+                 type_name(this->return_type) + "`");
+    }
+    this->ast.types[stmt] = type;
+  } break;
+  default:
+    type_error("Unexpected statement `" + std::string(this->ast.label(stmt)) +
+               "`");
+  }
+}
+
+void TypeChecker::check_function(NodeId fn) {
+  auto identifier = this->ast.child(fn, 0);
+  auto args = this->ast.child(fn, 1);
+  auto type = this->ast.child(fn, 2);
+
+  if (this->functions.declared_in_scope(this->ast.symbol(identifier))) {
+    type_error("Redefinition of function `" +
+               std::string(this->ast.name(identifier)) + "`");
+  }
+
+  Function func{};
+  func.type = this->ast.type(type);
+
+  // Arguments and locals live in the function's own scope.
+  this->variables.push_scope();
+
+  for (auto child : this->ast.children(args)) {
+    auto arg_type = this->ast.type(this->ast.child(child, 0));
+    this->ast.types[child] = arg_type;
+    this->variables.insert(this->ast.symbol(child), arg_type);
+    func.arguments.push_back(arg_type);
+  }
+
+  this->functions.insert(this->ast.symbol(identifier), func);
+  this->ast.types[identifier] = func.type;
+  this->ast.types[fn] = func.type;
+  this->return_type = func.type;
+
+  for (auto stmt : this->ast.children(this->ast.child(fn, 3))) {
+    if (this->ast.kind(stmt) == Fn) {
+      type_error("Functions can only be declared at the top level");
+    }
+    check_statement(stmt);
+  }
+
+  this->variables.pop_scope();
+}
+
+// Type of `lhs op rhs` when both operands have type `operands`.
+enum Type binary_type(Operator op, enum Type operands) {
+  switch (op) {
+  case Assign:
+    return operands;
+  case Eq:
+  case Ne:
+    return Type::Bool;
+  case Lt:
+  case Le:
+  case Gt:
+  case Ge:
+    return operands != Type::Bool ? Type::Bool : Type::Mismatch;
+  case And:
+  case Or:
+    return operands == Type::Bool ? Type::Bool : Type::Mismatch;
+  case BitAnd:
+  case BitOr:
+  case BitXor:
+    return is_integer(operands) || operands == Type::Bool ? operands
+                                                          : Type::Mismatch;
+  case Shl:
+  case Shr:
+    return is_integer(operands) ? operands : Type::Mismatch;
+  default:
+    return operands != Type::Bool ? operands : Type::Mismatch;
+  }
+}
+
+enum Type TypeChecker::check_expr(NodeId expr) {
+  enum Type type = Type::Mismatch;
+
+  switch (this->ast.kind(expr)) {
+  case BinaryExpr: {
+    if (this->ast.op(expr) == Operator::Assign &&
+        this->ast.kind(this->ast.child(expr, 0)) != Identifier) {
+      type_error("Cannot assign to `" +
+                 std::string(this->ast.label(this->ast.child(expr, 0))) + "`");
+    }
+    auto lhs = check_expr(this->ast.child(expr, 0));
+    auto rhs = check_expr(this->ast.child(expr, 1));
+    if (lhs == rhs) {
+      type = binary_type(this->ast.op(expr), lhs);
+    }
+  } break;
+  case Grouping:
+    type = check_expr(this->ast.child(expr, 0));
+    break;
+  case UnaryExpr: {
+    auto operand = check_expr(this->ast.child(expr, 0));
+    switch (this->ast.op(expr)) {
+    case Not:
+      type = operand == Type::Bool ? operand : Type::Mismatch;
+      break;
+    case BitNot:
+      type = is_integer(operand) ? operand : Type::Mismatch;
+      break;
+    default:
+      type = operand != Type::Bool ? operand : Type::Mismatch;
+      break;
+    }
+  } break;
+  case Integer:
+  case Float:
+    type = this->ast.type(expr);
+    break;
+  case Identifier:
+    if (auto var = this->variables.lookup(this->ast.symbol(expr))) {
+      type = *var;
+    }
+    break;
+  case Call: {
+    auto params = this->ast.child(expr, 0);
+    for (auto param : this->ast.children(params)) {
+      check_expr(param);
+    }
+
+    auto func = this->functions.lookup(this->ast.symbol(expr));
+    auto children = this->ast.children(params);
+    if (func && func->arguments.size() == children.size()) {
+      type = func->type;
+      for (size_t i = 0; i < children.size(); i++) {
+        if (func->arguments[i] != this->ast.type(children[i])) {
+          type = Type::Mismatch;
+        }
+      }
+    }
+  } break;
+  default:
+    break;
+  }
+
+  if (type == Type::Mismatch || type == Type::Void) {
+    type_error("Mismatched types!");
+  }
+
+  this->ast.types[expr] = type;
+  return type;
+}
+
+} // namespace ast
@@ -0,0 +1,40 @@
+#ifndef CHECKER_H_
+#define CHECKER_H_
+
+#include "ast.hpp"
+#include "symbols.hpp"
+#include <string>
+#include <vector>
+
+namespace ast {
+
+struct Function {
+  std::vector<enum Type> arguments;
+  enum Type type;
+};
+
+// Assigns a type to every node of a parsed program in a single walk. Each
+// node is visited once and its type is stored in `Ast::types`, so later
+// stages read it back instead of re-deriving it.
+class TypeChecker {
+public:
+  TypeChecker(Ast &ast);
+  void check();
+
+  SymbolTable<Symbol, enum Type> variables;
+  SymbolTable<Symbol, Function> functions;
+
+private:
+  void check_statement(NodeId stmt);
+  void check_function(NodeId fn);
+  enum Type check_expr(NodeId expr);
+
+  void type_error(std::string message);
+
+  Ast &ast;
+  enum Type return_type = Type::Void;
+};
+
+} // namespace ast
+
+#endif // CHECKER_H_
@@ -0,0 +1,72 @@
+#include "client.hpp"
+#include "protocol.hpp"
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <vector>
+
+int connect_server(const std::string &path, int argc, char **argv) {
+  auto address = socket_address(path);
+  int connection = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (connection < 0 ||
+      connect(connection, reinterpret_cast<sockaddr *>(&address),
+              sizeof(address)) != 0) {
+    std::cerr << "Could not connect to compile server at " << path << ": "
+              << strerror(errno) << std::endl;
+    exit(-1);
+  }
+
+  char cwd[PATH_MAX];
+  if (!getcwd(cwd, sizeof(cwd))) {
+    std::cerr << "Could not get working directory: " << strerror(errno)
+              << std::endl;
+    exit(-1);
+  }
+  std::vector<std::string> strings = {cwd, "brom"};
+  strings.insert(strings.end(), argv, argv + argc);
+  bool sent = write_u32(connection, strings.size());
+  for (auto &string : strings) {
+    sent = sent && write_u32(connection, string.size()) &&
+           write_all(connection, string.data(), string.size());
+  }
+  if (!sent) {
+    std::cerr << "Could not send request: " << strerror(errno) << std::endl;
+    exit(-1);
+  }
+
+  // Everything but the last four bytes is output, so hold them back until
+  // the connection is closed.
+  std::vector<char> pending;
+  char buffer[4096];
+  ssize_t got;
+  while ((got = read(connection, buffer, sizeof(buffer))) != 0) {
+    if (got < 0) {
+      if (errno == EINTR)
+        continue;
+      break;
+    }
+    pending.insert(pending.end(), buffer, buffer + got);
+    if (pending.size() > 4) {
+      size_t ready = pending.size() - 4;
+      write_all(STDOUT_FILENO, pending.data(), ready);
+      pending.erase(pending.begin(), pending.begin() + ready);
+    }
+  }
+  close(connection);
+
+  if (pending.size() != 4) {
+    std::cerr << "Compile server closed the connection" << std::endl;
+    return -1;
+  }
+  uint32_t code;
+  memcpy(&code, pending.data(), sizeof(code));
+  return static_cast<int>(ntohl(code));
+}
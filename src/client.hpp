@@ -0,0 +1,11 @@
+#ifndef CLIENT_H_
+#define CLIENT_H_
+
+#include <string>
+
+// Sends the command line `argv` and the working directory to the compile
+// server at `path`, prints what the compilation printed and returns its exit
+// code. Does not depend on LLVM, so it can be linked into a small client.
+int connect_server(const std::string &path, int argc, char **argv);
+
+#endif // CLIENT_H_
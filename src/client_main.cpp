@@ -0,0 +1,11 @@
+#include "client.hpp"
+#include "protocol.hpp"
+#include <cstdlib>
+
+// `brom-client <arguments>` is `brom --connect <arguments>` without loading
+// the compiler. `BROM_SOCKET` overrides the default socket.
+int main(int argc, char **argv) {
+  auto socket = getenv("BROM_SOCKET");
+  return connect_server(socket ? socket : default_socket(), argc - 1,
+                        argv + 1);
+}
@@ -1,9 +1,12 @@
 #include "compiler.hpp"
-#include "parser.hpp"
+#include "cache.hpp"
+#include "timing.hpp"
 #include <cstdlib>
 #include <iostream>
 #include <llvm/ADT/APInt.h>
 #include <llvm/ADT/Optional.h>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/ADT/StringMap.h>
 #include <llvm/IR/BasicBlock.h>
 #include <llvm/IR/Constant.h>
 #include <llvm/IR/Constants.h>
@@ -15,202 +18,839 @@
 #include <llvm/IR/Module.h>
 #include <llvm/IR/Type.h>
 #include <llvm/IR/Value.h>
+#include <llvm/IR/Verifier.h>
+#include <llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h>
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
+#include <llvm/Passes/PassBuilder.h>
 #include <llvm/Support/CodeGen.h>
 #include <llvm/Support/FileSystem.h>
 #include <llvm/Support/Host.h>
-#include <llvm/Support/TargetRegistry.h>
+#include <llvm/Support/Program.h>
+#include <llvm/MC/TargetRegistry.h>
 #include <llvm/Support/TargetSelect.h>
 #include <llvm/Support/raw_ostream.h>
 #include <llvm/Target/TargetMachine.h>
 #include <llvm/Target/TargetOptions.h>
 
+#include <algorithm>
 #include <memory>
+#include <mutex>
+#include <numeric>
 #include <string>
 #include <system_error>
 #include <vector>
 
-Compiler::Compiler(std::string source) {
-  context = std::make_unique<llvm::LLVMContext>();
-  module = std::make_unique<llvm::Module>("program", *context);
-  builder = std::make_unique<llvm::IRBuilder<>>(*context);
-  this->ast_root = (new ast::Parser(source))->ast_root;
+// Programs are only split once each partition gets about this many AST
+// nodes; below that the threads cost more than they save.
+constexpr size_t partition_nodes = 4096;
+
+Compiler::Compiler(const ast::Ast &ast, const CompileOptions &options,
+                   ThreadPool &pool)
+    : ast(&ast), options(options), pool(pool) {
+  for (auto stmt : this->ast->children(this->ast->root)) {
+    if (this->ast->kind(stmt) == ast::Fn) {
+      this->functions[this->ast->symbol(this->ast->child(stmt, 0))] = stmt;
+    }
+  }
 }
 
-void Compiler::compile() {
-  for (auto child : this->ast_root->children) {
-    this->compile_statement(child);
+size_t subtree_size(const ast::Ast &ast, ast::NodeId id) {
+  size_t size = 1;
+  for (auto child : ast.children(id)) {
+    size += subtree_size(ast, child);
+  }
+  return size;
+}
+
+// Splits the functions into one partition per `partition_nodes` AST nodes.
+// Each function goes to the lightest partition, largest first, and
+// partitions keep source order. The split depends on the program alone, not
+// on `-j` or the machine, so the same input always gives the same object.
+std::vector<std::vector<ast::NodeId>> Compiler::partition() const {
+  std::vector<ast::NodeId> fns;
+  std::vector<size_t> sizes;
+  size_t total = 0;
+  for (auto stmt : this->ast->children(this->ast->root)) {
+    if (this->ast->kind(stmt) == ast::Fn) {
+      fns.push_back(stmt);
+      sizes.push_back(subtree_size(*this->ast, stmt));
+      total += sizes.back();
+    }
+  }
+
+  size_t count = std::clamp<size_t>(total / partition_nodes, 1,
+                                    std::max<size_t>(fns.size(), 1));
+  if (count == 1) {
+    return {fns};
   }
 
-  std::string ir;
-  llvm::raw_string_ostream os(ir);
-  os << *module;
-  os.flush();
-  std::cout << ir << std::endl;
+  std::vector<size_t> order(fns.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&](size_t a, size_t b) { return sizes[a] > sizes[b]; });
 
+  std::vector<std::vector<ast::NodeId>> partitions(count);
+  std::vector<size_t> loads(count, 0);
+  for (auto i : order) {
+    size_t lightest =
+        std::min_element(loads.begin(), loads.end()) - loads.begin();
+    partitions[lightest].push_back(fns[i]);
+    loads[lightest] += sizes[i];
+  }
+  for (auto &partition : partitions) {
+    std::sort(partition.begin(), partition.end());
+  }
+  return partitions;
+}
 
-  llvm::InitializeNativeTarget();
-  llvm::InitializeNativeTargetAsmPrinter();
-  llvm::InitializeNativeTargetAsmParser();
+// `main` is always exported, it is the program's entry point.
+bool exported(const ast::Ast &ast, ast::NodeId fn) {
+  return ast.exported(fn) || ast.name(ast.child(fn, 0)) == "main";
+}
 
-  auto target_triple = llvm::sys::getDefaultTargetTriple();
-  module->setTargetTriple(target_triple);
+// Functions that have to be visible to the linker when the program is
+// split into `split`: the exported ones and those called from another
+// partition. A callee in no partition of `split` counts as another one.
+std::unordered_set<Symbol>
+Compiler::visible(const std::vector<std::vector<ast::NodeId>> &split) const {
+  std::unordered_set<Symbol> visible;
+  std::unordered_map<Symbol, size_t> owners;
+  for (size_t i = 0; i < split.size(); i++) {
+    for (auto fn : split[i]) {
+      auto symbol = this->ast->symbol(this->ast->child(fn, 0));
+      owners[symbol] = i;
+      if (exported(*this->ast, fn)) {
+        visible.insert(symbol);
+      }
+    }
+  }
+  if (split.size() < 2) {
+    return visible;
+  }
 
+  std::vector<ast::NodeId> pending;
+  for (size_t i = 0; i < split.size(); i++) {
+    for (auto fn : split[i]) {
+      pending.push_back(this->ast->child(fn, 3));
+      while (!pending.empty()) {
+        auto id = pending.back();
+        pending.pop_back();
+        if (this->ast->kind(id) == ast::Call) {
+          auto owner = owners.find(this->ast->symbol(id));
+          if (owner == owners.end() || owner->second != i) {
+            visible.insert(this->ast->symbol(id));
+          }
+        }
+        for (auto child : this->ast->children(id)) {
+          pending.push_back(child);
+        }
+      }
+    }
+  }
+  return visible;
+}
+
+std::unique_ptr<Partition>
+Compiler::generate(const std::vector<ast::NodeId> &fns, size_t index,
+                   const std::unordered_set<Symbol> &visible,
+                   llvm::TargetMachine &machine) const {
+  auto partition = std::make_unique<Partition>(
+      *this->ast, this->functions, this->target->cpu, this->target->features,
+      visible, this->options, "program." + std::to_string(index));
+  partition->module->setTargetTriple(this->target->triple);
+  partition->module->setDataLayout(machine.createDataLayout());
+
+  {
+    PhaseTimer timer(Phase::IRGen);
+    for (auto fn : fns) {
+      partition->define(fn);
+    }
+
+    if (llvm::verifyModule(*partition->module, &llvm::errs())) {
+      llvm::errs() << "Generated invalid IR\n";
+      exit(1);
+    }
+  }
+
+  PhaseTimer timer(Phase::Optimize);
+  optimize(*partition->module, machine);
+  return partition;
+}
+
+// Runs the tool `name` with `args` to perform `task`. Returns false, after
+// reporting why, if it cannot be run or fails.
+bool execute(const char *name, const std::vector<std::string> &args,
+             const char *task) {
+  auto program = llvm::sys::findProgramByName(name);
+  if (!program) {
+    llvm::errs() << "Could not find `" << name << "` to " << task << ": "
+                 << program.getError().message() << "\n";
+    return false;
+  }
+
+  std::vector<llvm::StringRef> argv = {*program};
+  argv.insert(argv.end(), args.begin(), args.end());
   std::string error;
-  auto target = llvm::TargetRegistry::lookupTarget(target_triple, error);
+  int status = llvm::sys::ExecuteAndWait(*program, argv, llvm::None, {}, 0, 0,
+                                         &error);
+  if (status != 0) {
+    llvm::errs() << "Could not " << task << (error.empty() ? "" : ": ")
+                 << error << "\n";
+    return false;
+  }
+  return true;
+}
+
+// Objects of a split program are combined into one relocatable object, so
+// the output is the same single file either way.
+void Compiler::link(std::vector<Object> &objects, bool localize) const {
+  PhaseTimer timer(Phase::Link);
+  if (objects.size() == 1 && objects[0].path.empty()) {
+    std::error_code ec;
+    llvm::raw_fd_ostream dest(this->options.output, ec,
+                              llvm::sys::fs::OF_None);
+    if (ec) {
+      llvm::errs() << "Could not open file: " << ec.message();
+      exit(1);
+    }
+    dest.write(objects[0].data.data(), objects[0].data.size());
+  } else if (objects.size() == 1) {
+    if (auto ec = llvm::sys::fs::copy_file(objects[0].path,
+                                           this->options.output)) {
+      llvm::errs() << "Could not open file: " << ec.message();
+      exit(1);
+    }
+  } else {
+    std::vector<std::string> args = {"-r", "-o", this->options.output};
+    std::vector<std::string> temporaries;
+    for (auto &object : objects) {
+      if (!object.path.empty()) {
+        args.push_back(object.path);
+        continue;
+      }
+      int fd;
+      llvm::SmallString<128> path;
+      if (auto ec =
+              llvm::sys::fs::createTemporaryFile("brom", "o", fd, path)) {
+        llvm::errs() << "Could not create temporary file: " << ec.message();
+        exit(1);
+      }
+      llvm::raw_fd_ostream dest(fd, true);
+      dest.write(object.data.data(), object.data.size());
+      args.push_back(path.str().str());
+      temporaries.push_back(path.str().str());
+    }
 
-  if (!target) {
-    llvm::errs() << error;
+    bool linked = execute("ld", args, "link partitions");
+    for (auto &path : temporaries) {
+      llvm::sys::fs::remove(path);
+    }
+    if (!linked) {
+      exit(1);
+    }
+  }
+
+  // Private functions called from another object are hidden globals so
+  // that `ld` can resolve those calls. Once the output holds every object
+  // they become local symbols, like the other private functions.
+  if (localize && !execute("objcopy", {"--localize-hidden", this->options.output},
+                           "localize private functions")) {
+    exit(1);
+  }
+}
+
+// Generates and emits every partition of `split` on the pool.
+std::vector<Object>
+Compiler::emit(const std::vector<std::vector<ast::NodeId>> &split,
+               const std::unordered_set<Symbol> &visible) const {
+  std::vector<std::unique_ptr<Partition>> partitions(split.size());
+
+  TaskGroup group;
+  for (size_t i = 0; i < split.size(); i++) {
+    this->pool.submit(group, [this, &split, &visible, &partitions, i] {
+      auto &machine = target_machine(*this->target);
+      partitions[i] = generate(split[i], i, visible, machine);
+
+      PhaseTimer timer(Phase::Codegen);
+      llvm::raw_svector_ostream dest(partitions[i]->object);
+      llvm::legacy::PassManager pass;
+      auto file_type = llvm::CGFT_ObjectFile;
+
+      if (machine.addPassesToEmitFile(pass, dest, nullptr, file_type)) {
+        llvm::errs() << "TheTargetMachine can't emit a file of this type";
+        exit(1);
+      }
+
+      pass.run(*partitions[i]->module);
+    });
+  }
+  this->pool.wait(group);
+
+  std::vector<Object> objects(partitions.size());
+  for (size_t i = 0; i < partitions.size(); i++) {
+    if (this->options.dump_ir) {
+      llvm::outs() << *partitions[i]->module << "\n";
+    }
+    objects[i].data = std::move(partitions[i]->object);
+  }
+  return objects;
+}
+
+// Every function is its own object, so an edit only recompiles the
+// functions whose key changed. Calls between functions are never inlined in
+// this mode.
+std::vector<Object>
+Compiler::emit_cached(const std::unordered_set<Symbol> &visible) const {
+  ObjectCache cache(this->options.cache_dir);
+
+  std::vector<Object> objects;
+  std::vector<std::string> keys;
+  std::vector<std::vector<ast::NodeId>> misses;
+  std::vector<size_t> missing;
+  for (auto stmt : this->ast->children(this->ast->root)) {
+    if (this->ast->kind(stmt) != ast::Fn)
+      continue;
+    keys.push_back(cache.key(*this->ast, stmt, this->functions, *this->target,
+                             this->options));
+    objects.emplace_back();
+    objects.back().path = cache.lookup(keys.back());
+    if (objects.back().path.empty()) {
+      misses.push_back({stmt});
+      missing.push_back(objects.size() - 1);
+    }
+  }
+
+  auto emitted = emit(misses, visible);
+  for (size_t i = 0; i < missing.size(); i++) {
+    auto &object = objects[missing[i]];
+    object.path = cache.store(keys[missing[i]], emitted[i].data);
+  }
+  return objects;
+}
+
+void Compiler::compile() {
+  this->target = &resolve_target(this->options);
+
+  bool cached = !this->options.cache_dir.empty() && !this->functions.empty();
+  std::unordered_set<Symbol> visible;
+  std::vector<Object> objects;
+  if (cached) {
+    // A cached object must not depend on who calls its function, so every
+    // function is visible.
+    for (auto &entry : this->functions) {
+      visible.insert(entry.first);
+    }
+    objects = emit_cached(visible);
+  } else {
+    auto split = partition();
+    visible = this->visible(split);
+    objects = emit(split, visible);
+  }
+
+  bool localize = std::any_of(
+      this->functions.begin(), this->functions.end(), [&](auto &entry) {
+        return visible.count(entry.first) &&
+               !exported(*this->ast, entry.second);
+      });
+  link(objects, localize);
+}
+
+unsigned return_bits(enum ast::Type type) {
+  switch (type) {
+  case ast::Type::Void:
+    return 0;
+  case ast::Type::Bool:
+    return 1;
+  case ast::Type::U8:
+  case ast::Type::I8:
+    return 8;
+  case ast::Type::U16:
+  case ast::Type::I16:
+    return 16;
+  case ast::Type::U32:
+  case ast::Type::I32:
+    return 32;
+  default:
+    return 64;
+  }
+}
+
+int Compiler::run() {
+  auto main_fn = std::find_if(
+      this->functions.begin(), this->functions.end(), [this](auto &entry) {
+        return this->ast->name(this->ast->child(entry.second, 0)) == "main";
+      });
+  if (main_fn == this->functions.end() ||
+      this->ast->children(this->ast->child(main_fn->second, 1)).size() != 0) {
+    llvm::errs() << "No `fn main()` to run\n";
+    exit(1);
+  }
+  auto return_type = this->ast->type(this->ast->child(main_fn->second, 2));
+  if (return_type == ast::Type::F32 || return_type == ast::Type::F64) {
+    llvm::errs() << "`main` has to return an integer or nothing\n";
     exit(1);
   }
+  unsigned bits = return_bits(return_type);
+
+  this->target = &resolve_target(this->options);
+
+  auto split = partition();
+  std::vector<std::unique_ptr<Partition>> partitions(split.size());
+  auto visible = this->visible(split);
+
+  TaskGroup group;
+  for (size_t i = 0; i < split.size(); i++) {
+    this->pool.submit(group, [this, &split, &visible, &partitions, i] {
+      partitions[i] =
+          generate(split[i], i, visible, target_machine(*this->target));
+    });
+  }
+  this->pool.wait(group);
 
-  auto cpu = "generic";
-  auto features = "";
-  llvm::TargetOptions opt;
-  auto rm = llvm::Optional<llvm::Reloc::Model>();
-  auto target_machine =
-      target->createTargetMachine(target_triple, cpu, features, opt, rm);
-  module->setDataLayout(target_machine->createDataLayout());
+  if (this->options.dump_ir) {
+    for (auto &partition : partitions) {
+      llvm::outs() << *partition->module << "\n";
+    }
+  }
 
-  auto filename = "output.o";
-  std::error_code ec;
-  llvm::raw_fd_ostream dest(filename, ec, llvm::sys::fs::OF_None);
+  auto jtmb = llvm::orc::JITTargetMachineBuilder::detectHost();
+  if (!jtmb) {
+    llvm::errs() << llvm::toString(jtmb.takeError()) << "\n";
+    exit(1);
+  }
+  jtmb->setCPU(this->target->cpu);
+  jtmb->addFeatures({this->target->features});
+  jtmb->setCodeGenOptLevel(this->target->level);
 
-  if (ec) {
-    llvm::errs() << "Could not open file: " << ec.message();
+  // Partitions are handed to the JIT's own compile threads.
+  auto jit = llvm::orc::LLJITBuilder()
+                 .setJITTargetMachineBuilder(std::move(*jtmb))
+                 .setNumCompileThreads(partitions.size() > 1 ? this->pool.size() : 0)
+                 .create();
+  if (!jit) {
+    llvm::errs() << llvm::toString(jit.takeError()) << "\n";
     exit(1);
   }
 
-  llvm::legacy::PassManager pass;
-  auto file_type = llvm::CGFT_ObjectFile;
+  for (auto &partition : partitions) {
+    partition->module->setDataLayout((*jit)->getDataLayout());
+    if (auto err = (*jit)->addIRModule(llvm::orc::ThreadSafeModule(
+            std::move(partition->module), std::move(partition->context)))) {
+      llvm::errs() << llvm::toString(std::move(err)) << "\n";
+      exit(1);
+    }
+  }
 
-  if (target_machine->addPassesToEmitFile(pass, dest, nullptr, file_type)) {
-    llvm::errs() << "TheTargetMachine can't emit a file of this type";
+  // The JIT compiles on first lookup.
+  auto symbol = [&] {
+    PhaseTimer timer(Phase::Codegen);
+    return (*jit)->lookup("main");
+  }();
+  if (!symbol) {
+    llvm::errs() << llvm::toString(symbol.takeError()) << "\n";
     exit(1);
   }
 
-  pass.run(*module);
-  dest.flush();
+  auto address = symbol->getAddress();
+  switch (bits) {
+  case 0:
+    reinterpret_cast<void (*)()>(address)();
+    return 0;
+  case 1:
+    return reinterpret_cast<int8_t (*)()>(address)() & 1;
+  case 8:
+    return reinterpret_cast<int8_t (*)()>(address)();
+  case 16:
+    return reinterpret_cast<int16_t (*)()>(address)();
+  case 32:
+    return reinterpret_cast<int32_t (*)()>(address)();
+  default:
+    return reinterpret_cast<int64_t (*)()>(address)();
+  }
+}
+
+// Runs the new pass manager's default pipeline for the requested level.
+void Compiler::optimize(llvm::Module &module,
+                        llvm::TargetMachine &machine) const {
+  llvm::LoopAnalysisManager lam;
+  llvm::FunctionAnalysisManager fam;
+  llvm::CGSCCAnalysisManager cgam;
+  llvm::ModuleAnalysisManager mam;
+
+  llvm::PassInstrumentationCallbacks callbacks;
+  TimeReport::instrument(callbacks);
+  llvm::PassBuilder pb(&machine, llvm::PipelineTuningOptions(), llvm::None,
+                       &callbacks);
+  pb.registerModuleAnalyses(mam);
+  pb.registerCGSCCAnalyses(cgam);
+  pb.registerFunctionAnalyses(fam);
+  pb.registerLoopAnalyses(lam);
+  pb.crossRegisterProxies(lam, fam, cgam, mam);
+
+  llvm::ModulePassManager mpm;
+  switch (this->options.opt_level) {
+  case OptLevel::O0:
+    mpm = pb.buildO0DefaultPipeline(llvm::OptimizationLevel::O0);
+    break;
+  case OptLevel::O1:
+    mpm = pb.buildPerModuleDefaultPipeline(llvm::OptimizationLevel::O1);
+    break;
+  case OptLevel::O2:
+    mpm = pb.buildPerModuleDefaultPipeline(llvm::OptimizationLevel::O2);
+    break;
+  case OptLevel::O3:
+    mpm = pb.buildPerModuleDefaultPipeline(llvm::OptimizationLevel::O3);
+    break;
+  case OptLevel::Os:
+    mpm = pb.buildPerModuleDefaultPipeline(llvm::OptimizationLevel::Os);
+    break;
+  }
 
+  mpm.run(module, mam);
 }
 
-llvm::Type *get_type(ast::Node *expr) {
-  if (expr->content == "u8") {
-    return llvm::Type::getInt8Ty(*context);
-  } else if (expr->content == "u16") {
-    return llvm::Type::getInt16Ty(*context);
-  } else if (expr->content == "u32") {
-    return llvm::Type::getInt32Ty(*context);
-  } else if (expr->content == "u64") {
-    return llvm::Type::getInt64Ty(*context);
-  } else if (expr->content == "i8") {
+Partition::Partition(const ast::Ast &ast,
+                     const std::unordered_map<Symbol, ast::NodeId> &functions,
+                     const std::string &cpu, const std::string &features,
+                     const std::unordered_set<Symbol> &visible,
+                     const CompileOptions &options, const std::string &name)
+    : ast(&ast), functions(&functions), visible(&visible), cpu(&cpu),
+      features(&features), options(&options) {
+  context = std::make_unique<llvm::LLVMContext>();
+  module = std::make_unique<llvm::Module>(name, *context);
+  builder = std::make_unique<llvm::IRBuilder<>>(*context);
+  // Applied by the builder to every floating point instruction it creates.
+  if (options.fast_math) {
+    llvm::FastMathFlags flags;
+    flags.setFast();
+    builder->setFastMathFlags(flags);
+  }
+}
+
+// Returns the function for `fn`, adding its prototype the first time.
+llvm::Function *Partition::declare(ast::NodeId fn) {
+  auto name = this->ast->name(this->ast->child(fn, 0));
+  if (auto func = module->getFunction(name)) {
+    return func;
+  }
+
+  std::vector<llvm::Type *> args;
+  for (auto arg : this->ast->children(this->ast->child(fn, 1))) {
+    args.push_back(get_type(this->ast->type(this->ast->child(arg, 0))));
+  }
+  auto return_type = this->ast->type(this->ast->child(fn, 2));
+  llvm::FunctionType *fn_type =
+      llvm::FunctionType::get(get_type(return_type), args, false);
+  // Until `define` gives it a body, the function may live in another
+  // partition's object, where private functions are hidden.
+  auto func = llvm::Function::Create(
+      fn_type, llvm::GlobalValue::ExternalLinkage, name, module.get());
+  if (!exported(*this->ast, fn)) {
+    func->setCallingConv(llvm::CallingConv::Fast);
+    func->setVisibility(llvm::GlobalValue::HiddenVisibility);
+  }
+  return func;
+}
+
+void Partition::define(ast::NodeId fn) {
+  llvm::Function *func = declare(fn);
+  if (!this->visible->count(this->ast->symbol(this->ast->child(fn, 0)))) {
+    func->setVisibility(llvm::GlobalValue::DefaultVisibility);
+    func->setLinkage(llvm::GlobalValue::InternalLinkage);
+  }
+  auto arguments = this->ast->children(this->ast->child(fn, 1));
+  auto return_type = this->ast->type(this->ast->child(fn, 2));
+  // Lets inlining and vectorization cost models see the real target.
+  func->addFnAttr("target-cpu", *this->cpu);
+  if (!this->features->empty()) {
+    func->addFnAttr("target-features", *this->features);
+  }
+  // The same promises for the instruction selector, which only reads
+  // function attributes.
+  if (this->options->fast_math) {
+    for (auto attribute : {"unsafe-fp-math", "no-nans-fp-math",
+                           "no-infs-fp-math", "no-signed-zeros-fp-math",
+                           "approx-func-fp-math"}) {
+      func->addFnAttr(attribute, "true");
+    }
+  }
+
+  llvm::BasicBlock *basic_block =
+      llvm::BasicBlock::Create(*context, "entry", func);
+  builder->SetInsertPoint(basic_block);
+
+  // Arguments are bound like any other variable.
+  find_assigned(fn);
+  this->variables.push_scope();
+  int i = 0;
+  for (auto &arg : func->args()) {
+    auto argument = arguments[i++];
+    arg.setName(this->ast->name(argument));
+    bind(argument, &arg);
+  }
+
+  for (auto statement : this->ast->children(this->ast->child(fn, 3))) {
+    compile_statement(statement);
+  }
+  if (return_type == ast::Type::Void) {
+    builder->CreateRetVoid();
+  }
+  this->variables.pop_scope();
+}
+
+// Collects the names assigned to in the body of `fn`. Bindings with any of
+// these names get a stack slot; shadowed bindings share their name, so they
+// are treated alike.
+void Partition::find_assigned(ast::NodeId fn) {
+  this->assigned.clear();
+  std::vector<ast::NodeId> pending;
+  for (auto stmt : this->ast->children(this->ast->child(fn, 3))) {
+    // The assignment of a `let` is the binding itself.
+    auto kind = this->ast->kind(stmt);
+    if (kind == ast::Let) {
+      pending.push_back(this->ast->child(this->ast->child(stmt, 0), 1));
+    } else if (kind == ast::Ret) {
+      pending.push_back(this->ast->child(stmt, 0));
+    }
+  }
+
+  while (!pending.empty()) {
+    auto expr = pending.back();
+    pending.pop_back();
+    if (this->ast->kind(expr) == ast::BinaryExpr &&
+        this->ast->op(expr) == ast::Operator::Assign) {
+      this->assigned.insert(this->ast->symbol(this->ast->child(expr, 0)));
+    }
+    for (auto child : this->ast->children(expr)) {
+      pending.push_back(child);
+    }
+  }
+}
+
+// Binds the variable declared by `binding` to `value`, through a stack slot
+// only if the variable is assigned to later.
+void Partition::bind(ast::NodeId binding, llvm::Value *value) {
+  auto symbol = this->ast->symbol(binding);
+  if (!this->assigned.count(symbol)) {
+    this->variables.insert(symbol, Variable{value, false});
+    return;
+  }
+
+  auto ptr = builder->CreateAlloca(value->getType(), nullptr,
+                                   this->ast->name(binding));
+  builder->CreateStore(value, ptr);
+  this->variables.insert(symbol, Variable{ptr, true});
+}
+
+// The checker only accepts programs whose variables are all bound, so a
+// miss here is a compiler bug.
+Partition::Variable &Partition::lookup(ast::NodeId identifier) {
+  auto variable = this->variables.lookup(this->ast->symbol(identifier));
+  if (!variable) {
+    llvm::errs() << "Internal error: no binding for variable `"
+                 << this->ast->name(identifier) << "`\n";
+    exit(1);
+  }
+  return *variable;
+}
+
+llvm::Type *Partition::get_type(enum ast::Type type) {
+  switch (type) {
+  case ast::Type::U8:
+  case ast::Type::I8:
     return llvm::Type::getInt8Ty(*context);
-  } else if (expr->content == "i16") {
+  case ast::Type::U16:
+  case ast::Type::I16:
     return llvm::Type::getInt16Ty(*context);
-  } else if (expr->content == "i32") {
+  case ast::Type::U32:
+  case ast::Type::I32:
     return llvm::Type::getInt32Ty(*context);
-  } else if (expr->content == "i64") {
+  case ast::Type::U64:
+  case ast::Type::I64:
     return llvm::Type::getInt64Ty(*context);
-  } else if (expr->content == "f32") {
+  case ast::Type::F32:
     return llvm::Type::getFloatTy(*context);
-  } else if (expr->content == "f64") {
-    return llvm::Type::getFloatTy(*context);
-  } else if (expr->content == "bool") {
+  case ast::Type::F64:
+    return llvm::Type::getDoubleTy(*context);
+  case ast::Type::Bool:
     return llvm::Type::getInt1Ty(*context);
-  } else if (expr->content == "void") {
-    return llvm::Type::getVoidTy(*context);
-  } else {
+  default:
     return llvm::Type::getVoidTy(*context);
   }
 }
 
-llvm::Value *Compiler::compile_expr(ast::Node *expr) {
-  if (expr->type == ast::NodeType::BinaryExpr) {
-    auto lhs = expr->children[0];
-    auto rhs = expr->children[1];
-    if (expr->content == "+") {
-      return builder->CreateAdd(compile_expr(lhs), compile_expr(rhs), "tmpadd");
-    } else if (expr->content == "-") {
-      return builder->CreateSub(compile_expr(lhs), compile_expr(rhs), "tmpadd");
-    } else if (expr->content == "*") {
-      return builder->CreateMul(compile_expr(lhs), compile_expr(rhs), "tmpadd");
-    } else if (expr->content == "/") {
-      return builder->CreateSDiv(compile_expr(lhs), compile_expr(rhs),
-                                 "tmpadd");
-    } else if (expr->content == "=") {
-      return builder->CreateStore(compile_expr(rhs),
-                                  this->variables[lhs->content]);
-    }
-  } else if (expr->type == ast::NodeType::Integer) {
-    return llvm::ConstantInt::get(get_type(expr->children[0]),
-                                  std::stoi(expr->content));
-  } else if (expr->type == ast::NodeType::UnaryExpr) {
-    return builder->CreateSub(
-        llvm::ConstantInt::get(get_type(expr->children[0]->children[0]), 0),
-        compile_expr(expr->children[0]), "tmpsub");
-  } else if (expr->type == ast::NodeType::Grouping) {
-    return compile_expr(expr->children[0]);
-  } else if (expr->type == ast::NodeType::Call) {
-    llvm::Function *callee = module->getFunction(expr->content);
+llvm::Value *Partition::compile_expr(ast::NodeId expr) {
+  switch (this->ast->kind(expr)) {
+  case ast::NodeType::BinaryExpr:
+    return compile_binary(expr);
+  case ast::NodeType::Integer:
+  case ast::NodeType::Float: {
+    // Parsed from the text so that 64-bit values and the negative constants
+    // left by the simplifier keep their full value. An integer literal may
+    // also have a floating point suffix, as in `2f32`.
+    auto type = get_type(this->ast->type(expr));
+    auto text = llvm::StringRef(this->ast->name(expr));
+    if (type->isFloatingPointTy()) {
+      return llvm::ConstantFP::get(type, text);
+    }
+    return llvm::ConstantInt::get(llvm::cast<llvm::IntegerType>(type), text,
+                                  10);
+  }
+  case ast::NodeType::UnaryExpr: {
+    auto operand = compile_expr(this->ast->child(expr, 0));
+    if (this->ast->op(expr) != ast::Operator::Negate) {
+      return builder->CreateNot(operand, "tmpnot");
+    }
+    auto type = this->ast->type(expr);
+    if (ast::is_float(type)) {
+      return builder->CreateFNeg(operand, "tmpneg");
+    }
+    bool no_wrap = this->options->overflow == Overflow::Undefined;
+    return builder->CreateNeg(operand, "tmpneg", false,
+                              no_wrap && ast::is_signed(type));
+  }
+  case ast::NodeType::Grouping:
+    return compile_expr(this->ast->child(expr, 0));
+  case ast::NodeType::Call: {
+    auto name = this->ast->name(expr);
+    llvm::Function *callee =
+        declare(this->functions->at(this->ast->symbol(expr)));
     std::vector<llvm::Value *> args;
-    for (auto arg : expr->children[0]->children) {
+    for (auto arg : this->ast->children(this->ast->child(expr, 0))) {
       args.push_back(compile_expr(arg));
     }
 
-    return builder->CreateCall(callee, args, "tmpcall" + expr->content);
-  } else if (expr->type == ast::NodeType::Identifier) {
+    auto call =
+        builder->CreateCall(callee, args, "tmpcall" + llvm::StringRef(name));
+    call->setCallingConv(callee->getCallingConv());
+    return call;
+  }
+  case ast::NodeType::Identifier: {
+    auto variable = lookup(expr);
+    if (!variable.slot) {
+      return variable.value;
+    }
     return builder->CreateLoad(
-        variables[expr->content]->getType()->getPointerElementType(),
-        variables[expr->content]);
+        variable.value->getType()->getPointerElementType(), variable.value);
+  }
+  default:
+    return nullptr;
   }
 }
 
-void Compiler::compile_statement(ast::Node *stmt) {
-  switch (stmt->type) {
-  case ast::Fn: {
-
-    this->variables.clear();
-
-    // Generate arguments
-    std::vector<llvm::Type *> args;
-    auto arguments = stmt->children[1]->children;
-    for (auto arg : arguments) {
-      args.push_back(get_type(arg->children[0]));
-    }
-    // Generate function type
-    llvm::FunctionType *fn_type =
-        llvm::FunctionType::get(get_type(stmt->children[2]), args, false);
-    llvm::Function *func =
-        llvm::Function::Create(fn_type, llvm::GlobalValue::ExternalLinkage,
-                               stmt->children[0]->content, module.get());
-
-    int i = 0;
-    for (auto &arg : func->args()) {
-      arg.setName(arguments[i]->content);
-      this->variables[arguments[i]->content] = &arg;
-    }
-
-    llvm::BasicBlock *basic_block =
-        llvm::BasicBlock::Create(*context, "entry", func);
-    builder->SetInsertPoint(basic_block);
+llvm::Value *Partition::compile_binary(ast::NodeId expr) {
+  auto lhs = this->ast->child(expr, 0);
+  auto rhs = this->ast->child(expr, 1);
+  auto op = this->ast->op(expr);
+  if (op == ast::Operator::Assign) {
+    auto value = compile_expr(rhs);
+    builder->CreateStore(value, lookup(lhs).value);
+    return value;
+  }
+  auto left = compile_expr(lhs);
+  auto right = compile_expr(rhs);
+  auto type = this->ast->type(lhs);
+  if (ast::is_float(type)) {
+    return compile_float_binary(op, left, right);
+  }
 
-    auto block = stmt->children[3]->children;
+  // Instructions are chosen by the operands' type: division, ordered
+  // comparisons and right shifts differ between signed and unsigned, and
+  // the overflow mode decides whether arithmetic may assume no wrapping.
+  bool is_signed = ast::is_signed(type);
+  bool no_wrap = this->options->overflow == Overflow::Undefined &&
+                 type != ast::Type::Bool;
+  bool nuw = no_wrap && !is_signed;
+  bool nsw = no_wrap && is_signed;
+  switch (op) {
+  case ast::Operator::Add:
+    return builder->CreateAdd(left, right, "tmpadd", nuw, nsw);
+  case ast::Operator::Sub:
+    return builder->CreateSub(left, right, "tmpsub", nuw, nsw);
+  case ast::Operator::Mul:
+    return builder->CreateMul(left, right, "tmpmul", nuw, nsw);
+  case ast::Operator::Div:
+    return is_signed ? builder->CreateSDiv(left, right, "tmpdiv")
+                     : builder->CreateUDiv(left, right, "tmpdiv");
+  case ast::Operator::Eq:
+    return builder->CreateICmpEQ(left, right, "tmpcmp");
+  case ast::Operator::Ne:
+    return builder->CreateICmpNE(left, right, "tmpcmp");
+  case ast::Operator::Lt:
+    return is_signed ? builder->CreateICmpSLT(left, right, "tmpcmp")
+                     : builder->CreateICmpULT(left, right, "tmpcmp");
+  case ast::Operator::Le:
+    return is_signed ? builder->CreateICmpSLE(left, right, "tmpcmp")
+                     : builder->CreateICmpULE(left, right, "tmpcmp");
+  case ast::Operator::Gt:
+    return is_signed ? builder->CreateICmpSGT(left, right, "tmpcmp")
+                     : builder->CreateICmpUGT(left, right, "tmpcmp");
+  case ast::Operator::Ge:
+    return is_signed ? builder->CreateICmpSGE(left, right, "tmpcmp")
+                     : builder->CreateICmpUGE(left, right, "tmpcmp");
+  // Operands have no side effects, so `&&` and `||` can evaluate both
+  // sides without branching.
+  case ast::Operator::BitAnd:
+  case ast::Operator::And:
+    return builder->CreateAnd(left, right, "tmpand");
+  case ast::Operator::BitOr:
+  case ast::Operator::Or:
+    return builder->CreateOr(left, right, "tmpor");
+  case ast::Operator::BitXor:
+    return builder->CreateXor(left, right, "tmpxor");
+  case ast::Operator::Shl:
+    return builder->CreateShl(left, right, "tmpshl", nuw, nsw);
+  case ast::Operator::Shr:
+    return is_signed ? builder->CreateAShr(left, right, "tmpshr")
+                     : builder->CreateLShr(left, right, "tmpshr");
+  default:
+    return nullptr;
+  }
+}
 
-    for (auto statement : block) {
-      compile_statement(statement);
-    }
-    if (stmt->children[2]->content == "void") {
-      builder->CreateRetVoid();
-    }
-    break;
+// `==` and the ordered comparisons are false when either operand is NaN,
+// `!=` is true, as in C.
+llvm::Value *Partition::compile_float_binary(ast::Operator op,
+                                             llvm::Value *left,
+                                             llvm::Value *right) {
+  switch (op) {
+  case ast::Operator::Add:
+    return builder->CreateFAdd(left, right, "tmpadd");
+  case ast::Operator::Sub:
+    return builder->CreateFSub(left, right, "tmpsub");
+  case ast::Operator::Mul:
+    return builder->CreateFMul(left, right, "tmpmul");
+  case ast::Operator::Div:
+    return builder->CreateFDiv(left, right, "tmpdiv");
+  case ast::Operator::Eq:
+    return builder->CreateFCmpOEQ(left, right, "tmpcmp");
+  case ast::Operator::Ne:
+    return builder->CreateFCmpUNE(left, right, "tmpcmp");
+  case ast::Operator::Lt:
+    return builder->CreateFCmpOLT(left, right, "tmpcmp");
+  case ast::Operator::Le:
+    return builder->CreateFCmpOLE(left, right, "tmpcmp");
+  case ast::Operator::Gt:
+    return builder->CreateFCmpOGT(left, right, "tmpcmp");
+  case ast::Operator::Ge:
+    return builder->CreateFCmpOGE(left, right, "tmpcmp");
+  default:
+    return nullptr;
   }
+}
+
+void Partition::compile_statement(ast::NodeId stmt) {
+  switch (this->ast->kind(stmt)) {
   case ast::Let: {
-    auto ptr = builder->CreateAlloca(
-        get_type(stmt->children[0]->children[1]->children[0]), nullptr,
-        stmt->children[0]->children[0]->content);
-    this->variables[stmt->children[0]->children[0]->content] = ptr;
-    compile_expr(stmt->children[0]);
+    auto assignment = this->ast->child(stmt, 0);
+    auto identifier = this->ast->child(assignment, 0);
+    bind(identifier, compile_expr(this->ast->child(assignment, 1)));
   } break;
   case ast::Ret:
-    builder->CreateRet(compile_expr(stmt->children[0]));
+    builder->CreateRet(compile_expr(this->ast->child(stmt, 0)));
+    break;
+  default:
+    break;
   }
 }
@@ -1,30 +1,118 @@
 #ifndef COMPILER_H_
 #define COMPILER_H_
 
-#include "parser.hpp"
+#include "ast.hpp"
+#include "options.hpp"
+#include "symbols.hpp"
+#include "target.hpp"
+#include "thread_pool.hpp"
+#include <llvm/ADT/SmallVector.h>
 #include <llvm/IR/IRBuilder.h>
 #include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/Module.h>
 #include <llvm/IR/Value.h>
-#include <map>
+#include <llvm/Target/TargetMachine.h>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
-static std::unique_ptr<llvm::LLVMContext> context;
-static std::unique_ptr<llvm::IRBuilder<>> builder;
-static std::unique_ptr<llvm::Module> module;
+// IR for a subset of the program's functions. Every partition owns its
+// context and module, so partitions can be generated, optimized and emitted
+// on different threads. Functions defined in another partition are only
+// declared here and resolved when the objects are linked.
+//
+// Functions that are not `pub` use the `fastcc` calling convention and get
+// internal linkage, so the optimizer is free to inline, specialize or drop
+// them. Those another partition calls are hidden globals instead, made local
+// after linking.
+class Partition {
+public:
+  Partition(const ast::Ast &ast,
+            const std::unordered_map<Symbol, ast::NodeId> &functions,
+            const std::string &cpu, const std::string &features,
+            const std::unordered_set<Symbol> &visible,
+            const CompileOptions &options, const std::string &name);
+
+  void define(ast::NodeId fn);
+
+  std::unique_ptr<llvm::LLVMContext> context;
+  std::unique_ptr<llvm::Module> module;
+  // Optimized object code, filled in by `Compiler::compile`.
+  llvm::SmallVector<char, 0> object;
+
+private:
+  llvm::Function *declare(ast::NodeId fn);
+  llvm::Type *get_type(enum ast::Type type);
+  llvm::Value *compile_expr(ast::NodeId expr);
+  llvm::Value *compile_binary(ast::NodeId expr);
+  llvm::Value *compile_float_binary(ast::Operator op, llvm::Value *left,
+                                    llvm::Value *right);
+  void compile_statement(ast::NodeId stmt);
+  void find_assigned(ast::NodeId fn);
+  void bind(ast::NodeId binding, llvm::Value *value);
+
+  const ast::Ast *ast;
+  // Every function in the program by name, for declaring callees.
+  const std::unordered_map<Symbol, ast::NodeId> *functions;
+  // Functions that keep external linkage, hidden unless exported.
+  const std::unordered_set<Symbol> *visible;
+  const std::string *cpu;
+  const std::string *features;
+  const CompileOptions *options;
+  std::unique_ptr<llvm::IRBuilder<>> builder;
+  // Variables that are never assigned to after their binding are the SSA
+  // value they were bound to; the others live in a stack slot.
+  struct Variable {
+    llvm::Value *value;
+    bool slot;
+  };
+  SymbolTable<Symbol, Variable> variables;
+  Variable &lookup(ast::NodeId identifier);
+  // Names assigned to anywhere in the function being defined.
+  std::unordered_set<Symbol> assigned;
+};
+
+// Object code of a partition, in memory or already on disk.
+struct Object {
+  llvm::SmallVector<char, 0> data;
+  std::string path;
+};
 
 class Compiler {
 public:
-  ast::Node *ast_root;
-  Compiler(std::string source);
+  const ast::Ast *ast;
+  const CompileOptions &options;
+  // Partitions are built on `pool`, which may be shared with other jobs.
+  Compiler(const ast::Ast &ast, const CompileOptions &options,
+           ThreadPool &pool);
+  // Writes an object file to `options.output`.
   void compile();
+  // JIT-compiles the program in-process and returns the result of `main`.
+  int run();
 
 private:
-  llvm::Value *compile_expr(ast::Node *expr);
-  void compile_statement(ast::Node *stmt);
-        std::map<std::string, llvm::Value*> variables;
+  std::vector<std::vector<ast::NodeId>> partition() const;
+  std::unordered_set<Symbol>
+  visible(const std::vector<std::vector<ast::NodeId>> &split) const;
+  // Builds, verifies and optimizes one partition.
+  std::unique_ptr<Partition>
+  generate(const std::vector<ast::NodeId> &fns, size_t index,
+           const std::unordered_set<Symbol> &visible,
+           llvm::TargetMachine &machine) const;
+  void optimize(llvm::Module &module, llvm::TargetMachine &machine) const;
+  std::vector<Object> emit(const std::vector<std::vector<ast::NodeId>> &split,
+                           const std::unordered_set<Symbol> &visible) const;
+  std::vector<Object>
+  emit_cached(const std::unordered_set<Symbol> &visible) const;
+  // Combines `objects` into `options.output`, then makes hidden symbols
+  // local if `localize` is set.
+  void link(std::vector<Object> &objects, bool localize) const;
+
+  ThreadPool &pool;
+  std::unordered_map<Symbol, ast::NodeId> functions;
+  const Target *target = nullptr;
 };
 
 #endif // COMPILER_H_
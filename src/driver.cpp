@@ -0,0 +1,185 @@
+#include "driver.hpp"
+#include "options.hpp"
+#include "pipeline.hpp"
+#include "source.hpp"
+#include "thread_pool.hpp"
+#include "timing.hpp"
+#include <atomic>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+void usage() {
+  std::cout << "Usage: brom [run] [-O0|-O1|-O2|-O3|-Os] [-march=native|<cpu>] "
+               "[-mcpu=<cpu>] [-mattr=<+feature,-feature>] [--dump-ast] "
+               "[--dump-ir] [--overflow=wrap|undefined] [--fast-math] "
+               "[-j<jobs>] [--cache-dir=<dir>] "
+               "[--time-report[=json]] [-o <output>] <file>...\n"
+               "       brom --server[=<socket>]\n"
+               "       brom --connect[=<socket>] <arguments>..."
+            << std::endl;
+  exit(-1);
+}
+
+// `dir/name.br` compiles to `dir/name.o` when a batch has several inputs.
+std::string object_path(const std::string &filename) {
+  auto slash = filename.find_last_of('/');
+  auto dot = filename.find_last_of('.');
+  if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+    return filename + ".o";
+  return filename.substr(0, dot) + ".o";
+}
+
+// Thread count of `-j`: a plain decimal number, anything else is a usage
+// error.
+unsigned parse_jobs(const std::string &text) {
+  if (text.empty() || text.size() > 4 ||
+      text.find_first_not_of("0123456789") != std::string::npos)
+    usage();
+  return std::stoul(text);
+}
+
+// Prints a diagnostic for `filename`. Files of a batch fail independently,
+// so every message names the file it is about.
+void report(const std::string &filename, const CompileError &error) {
+  std::ostringstream message;
+  message << filename << ": " << error.what() << "\n";
+  std::cout << message.str() << std::flush;
+}
+
+int drive(int argc, char **argv) {
+  std::vector<std::string> filenames;
+  std::string output;
+  CompileOptions options;
+  bool time_report = false;
+  auto report_format = TimeReport::Format::Text;
+
+  // `brom run <file>` executes the program through the JIT instead of
+  // writing an object file.
+  bool run = argc > 1 && std::string(argv[1]) == "run";
+  // JIT-compiled code always runs on this machine.
+  options.native = run;
+
+  for (int i = run ? 2 : 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--dump-ast") {
+      options.dump_ast = true;
+    } else if (arg == "--dump-ir") {
+      options.dump_ir = true;
+    } else if (arg == "-O0") {
+      options.opt_level = OptLevel::O0;
+    } else if (arg == "-O1") {
+      options.opt_level = OptLevel::O1;
+    } else if (arg == "-O2" || arg == "-O") {
+      options.opt_level = OptLevel::O2;
+    } else if (arg == "-O3") {
+      options.opt_level = OptLevel::O3;
+    } else if (arg == "-Os") {
+      options.opt_level = OptLevel::Os;
+    } else if (arg == "-march=native") {
+      options.native = true;
+    } else if (arg.rfind("-march=", 0) == 0) {
+      options.cpu = arg.substr(7);
+    } else if (arg.rfind("-mcpu=", 0) == 0) {
+      options.cpu = arg.substr(6);
+    } else if (arg.rfind("-mattr=", 0) == 0) {
+      options.features = arg.substr(7);
+    } else if (arg == "--overflow=wrap") {
+      options.overflow = Overflow::Wrap;
+    } else if (arg == "--overflow=undefined") {
+      options.overflow = Overflow::Undefined;
+    } else if (arg == "--fast-math") {
+      options.fast_math = true;
+    } else if (arg == "-j" && i + 1 < argc) {
+      options.jobs = parse_jobs(argv[++i]);
+    } else if (arg.rfind("-j", 0) == 0 && arg.size() > 2) {
+      options.jobs = parse_jobs(arg.substr(2));
+    } else if (arg.rfind("--cache-dir=", 0) == 0) {
+      options.cache_dir = arg.substr(12);
+    } else if (arg == "--time-report") {
+      time_report = true;
+    } else if (arg == "--time-report=json") {
+      time_report = true;
+      report_format = TimeReport::Format::Json;
+    } else if (arg == "-o" && i + 1 < argc) {
+      output = argv[++i];
+    } else if (arg[0] == '-') {
+      usage();
+    } else {
+      filenames.push_back(arg);
+    }
+  }
+
+  if (filenames.empty() || (run && filenames.size() > 1) ||
+      (!output.empty() && filenames.size() > 1))
+    usage();
+
+  if (time_report) {
+    TimeReport::enable();
+    // LLVM's pass timers are process-wide and cannot be shared by threads.
+    options.jobs = 1;
+  }
+
+  // One pool for the whole batch: files are compiled concurrently and the
+  // partitions of each file are scheduled on the same threads.
+  ThreadPool pool(ThreadPool::concurrency(options.jobs) - 1);
+
+  if (run) {
+    int result;
+    try {
+      SourceFile file(filenames[0]);
+      Pipeline pipeline(file.text());
+      pipeline.options = options;
+      pipeline.lex();
+      pipeline.parse();
+      pipeline.check();
+      pipeline.simplify();
+      result = pipeline.run(pool);
+    } catch (const CompileError &error) {
+      report(filenames[0], error);
+      return -1;
+    }
+    if (time_report) {
+      TimeReport::print(std::cerr, report_format);
+    }
+    return result;
+  }
+
+  // A file that fails is reported by its own job; the others still finish
+  // before the batch exits, so no thread is left running during shutdown.
+  std::atomic<bool> failed{false};
+  TaskGroup jobs;
+  for (auto &filename : filenames) {
+    CompileOptions file_options = options;
+    if (!output.empty()) {
+      file_options.output = output;
+    } else if (filenames.size() > 1) {
+      file_options.output = object_path(filename);
+    }
+
+    std::cout << "Compiling " << filename << std::endl;
+    pool.submit(jobs, [&pool, &filename, &failed, file_options] {
+      try {
+        SourceFile file(filename);
+        Pipeline pipeline(file.text());
+        pipeline.options = file_options;
+        pipeline.lex();
+        pipeline.parse();
+        pipeline.check();
+        pipeline.simplify();
+        pipeline.compile(pool);
+      } catch (const CompileError &error) {
+        report(filename, error);
+        failed = true;
+      }
+    });
+  }
+  pool.wait(jobs);
+
+  if (time_report) {
+    TimeReport::print(std::cerr, report_format);
+  }
+
+  return failed ? -1 : 0;
+}
@@ -0,0 +1,11 @@
+#ifndef DRIVER_H_
+#define DRIVER_H_
+
+// Parses a `brom` command line and compiles or runs the files it names,
+// returning the process exit code. Used by `main` and by the compile server
+// for each request it forwards.
+int drive(int argc, char **argv);
+
+void usage();
+
+#endif // DRIVER_H_
@@ -0,0 +1,13 @@
+#include "interner.hpp"
+
+Symbol Interner::intern(std::string_view text) {
+  auto it = this->index.find(text);
+  if (it != this->index.end())
+    return it->second;
+
+  Symbol symbol = this->names.size();
+  auto stored = this->storage.copy(text);
+  this->names.push_back(stored);
+  this->index.emplace(stored, symbol);
+  return symbol;
+}
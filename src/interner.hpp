@@ -0,0 +1,39 @@
+#ifndef INTERNER_H_
+#define INTERNER_H_
+
+#include "arena.hpp"
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Compact id of an interned string. Two equal strings interned by the same
+// `Interner` always get the same id.
+using Symbol = uint32_t;
+constexpr Symbol NoSymbol = UINT32_MAX;
+
+// Maps every distinct identifier and literal of a compilation to a
+// `Symbol`. The lexer interns each lexeme once and every later stage carries
+// and compares symbols; the text is only looked up again for diagnostics and
+// for naming LLVM values.
+class Interner {
+public:
+  Interner() = default;
+  Interner(const Interner &) = delete;
+  Interner &operator=(const Interner &) = delete;
+
+  Symbol intern(std::string_view text);
+  std::string_view name(Symbol symbol) const { return this->names[symbol]; }
+
+  // Number of distinct strings and bytes of text stored for them.
+  size_t size() const { return this->names.size(); }
+  size_t bytes() const { return this->storage.bytes_used(); }
+
+private:
+  Arena storage;
+  std::vector<std::string_view> names;
+  // Keys are views into `storage`.
+  std::unordered_map<std::string_view, Symbol> index;
+};
+
+#endif // INTERNER_H_
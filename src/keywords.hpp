@@ -0,0 +1,99 @@
+#ifndef KEYWORDS_H_
+#define KEYWORDS_H_
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+namespace tokenizer {
+
+// Reserved words. Type names follow the order of `ast::Type`.
+enum class Keyword : uint8_t {
+  None,
+  Let,
+  Fn,
+  Ret,
+  Pub,
+  U8,
+  U16,
+  U32,
+  U64,
+  I8,
+  I16,
+  I32,
+  I64,
+  F32,
+  F64,
+  Bool,
+  Void,
+};
+
+namespace keywords {
+
+struct Entry {
+  std::string_view text;
+  Keyword keyword;
+};
+
+constexpr Entry all[] = {
+    {"let", Keyword::Let}, {"fn", Keyword::Fn},     {"ret", Keyword::Ret},
+    {"pub", Keyword::Pub},
+    {"u8", Keyword::U8},   {"u16", Keyword::U16},   {"u32", Keyword::U32},
+    {"u64", Keyword::U64}, {"i8", Keyword::I8},     {"i16", Keyword::I16},
+    {"i32", Keyword::I32}, {"i64", Keyword::I64},   {"f32", Keyword::F32},
+    {"f64", Keyword::F64}, {"bool", Keyword::Bool}, {"void", Keyword::Void},
+};
+
+constexpr size_t min_length = 2;
+constexpr size_t max_length = 4;
+constexpr size_t table_size = 32;
+
+// Perfect hash over the keyword set: every keyword lands in its own slot, so
+// a lookup is one hash and at most one comparison.
+constexpr size_t hash(std::string_view text) {
+  return (static_cast<unsigned char>(text.front()) +
+          4 * static_cast<unsigned char>(text.back())) %
+         table_size;
+}
+
+constexpr std::array<Entry, table_size> build_table() {
+  std::array<Entry, table_size> table{};
+  for (auto &entry : all) {
+    table[hash(entry.text)] = entry;
+  }
+  return table;
+}
+
+constexpr std::array<Entry, table_size> table = build_table();
+
+constexpr bool is_perfect() {
+  for (auto &entry : all) {
+    if (table[hash(entry.text)].keyword != entry.keyword)
+      return false;
+  }
+  return true;
+}
+
+static_assert(is_perfect(), "keyword hash has collisions, pick a new one");
+
+} // namespace keywords
+
+// Maps a word to its keyword, or `Keyword::None` for plain identifiers.
+constexpr Keyword lookup_keyword(std::string_view text) {
+  if (text.size() < keywords::min_length || text.size() > keywords::max_length)
+    return Keyword::None;
+  auto &entry = keywords::table[keywords::hash(text)];
+  return entry.text == text ? entry.keyword : Keyword::None;
+}
+
+constexpr bool is_type(Keyword keyword) {
+  return keyword >= Keyword::U8 && keyword <= Keyword::Void;
+}
+
+static_assert(lookup_keyword("u16") == Keyword::U16, "");
+static_assert(lookup_keyword("void") == Keyword::Void, "");
+static_assert(lookup_keyword("lets") == Keyword::None, "");
+
+} // namespace tokenizer
+
+#endif // KEYWORDS_H_
@@ -1,175 +1,191 @@
 #include "lexer.hpp"
+#include "scan.hpp"
+#include "source.hpp"
 #include "token.hpp"
-#include <cctype>
-#include <iostream>
-#include <ostream>
+#include <string>
+#include <string_view>
 
 namespace tokenizer {
-Lexer::Lexer(std::string source) {
-  this->head = new Token(TokenType::None, "");
-  this->last = head;
+Lexer::Lexer(std::string_view source, Interner &interner) {
+  // Most tokens span a few bytes, this avoids regrowing the array on
+  // typical sources without over-allocating much.
+  this->tokens.reserve(source.size() / 4 + 1);
 
   int line = 0;
-  int cc = 0;
-  std::string identifier;
-  const char *s = source.c_str();
-  while (*s != '\0' && s != nullptr) {
-    if (*s == '\n') {
-      line++;
-      s++;
-      continue;
-    }
-
+  const char *s = source.data();
+  const char *end = s + source.size();
+  while (s < end && *s != '\0') {
     switch (*s) {
     case '+':
-      this->push(new Token(TokenType::Plus, "+"));
+      this->push(TokenType::Plus, s, 1);
       s++;
-      break;
+      continue;
     case '-':
-      if (*(s + 1) == '>') {
-        this->push(new Token(TokenType::RightArrow, "->"));
+      if (s + 1 < end && *(s + 1) == '>') {
+        this->push(TokenType::RightArrow, s, 2);
         s += 2;
-        break;
+        continue;
       }
-      this->push(new Token(TokenType::Minus, "-"));
+      this->push(TokenType::Minus, s, 1);
       s++;
-      break;
+      continue;
     case '*':
-      this->push(new Token(TokenType::Star, "*"));
+      this->push(TokenType::Star, s, 1);
       s++;
-      break;
+      continue;
     case '/':
-      this->push(new Token(TokenType::Slash, "/"));
+      this->push(TokenType::Slash, s, 1);
       s++;
-      break;
+      continue;
     case '(':
-      this->push(new Token(TokenType::LParen, "("));
+      this->push(TokenType::LParen, s, 1);
       s++;
-      break;
+      continue;
     case ')':
-      this->push(new Token(TokenType::RParen, ")"));
+      this->push(TokenType::RParen, s, 1);
       s++;
-      break;
+      continue;
     case '=':
-      this->push(new Token(TokenType::Equal, "="));
+      if (s + 1 < end && *(s + 1) == '=') {
+        this->push(TokenType::EqualEqual, s, 2);
+        s += 2;
+        continue;
+      }
+      this->push(TokenType::Equal, s, 1);
+      s++;
+      continue;
+    case '!':
+      if (s + 1 < end && *(s + 1) == '=') {
+        this->push(TokenType::BangEqual, s, 2);
+        s += 2;
+        continue;
+      }
+      this->push(TokenType::Bang, s, 1);
+      s++;
+      continue;
+    case '<':
+      if (s + 1 < end && (*(s + 1) == '=' || *(s + 1) == '<')) {
+        this->push(*(s + 1) == '=' ? TokenType::LessEqual : TokenType::LessLess,
+                   s, 2);
+        s += 2;
+        continue;
+      }
+      this->push(TokenType::Less, s, 1);
+      s++;
+      continue;
+    case '>':
+      if (s + 1 < end && (*(s + 1) == '=' || *(s + 1) == '>')) {
+        this->push(*(s + 1) == '=' ? TokenType::GreaterEqual
+                                   : TokenType::GreaterGreater,
+                   s, 2);
+        s += 2;
+        continue;
+      }
+      this->push(TokenType::Greater, s, 1);
+      s++;
+      continue;
+    case '&':
+      if (s + 1 < end && *(s + 1) == '&') {
+        this->push(TokenType::AmpAmp, s, 2);
+        s += 2;
+        continue;
+      }
+      this->push(TokenType::Amp, s, 1);
       s++;
-      break;
+      continue;
+    case '|':
+      if (s + 1 < end && *(s + 1) == '|') {
+        this->push(TokenType::PipePipe, s, 2);
+        s += 2;
+        continue;
+      }
+      this->push(TokenType::Pipe, s, 1);
+      s++;
+      continue;
+    case '^':
+      this->push(TokenType::Caret, s, 1);
+      s++;
+      continue;
+    case '~':
+      this->push(TokenType::Tilde, s, 1);
+      s++;
+      continue;
     case ';':
-      this->push(new Token(TokenType::SemiColon, ";"));
+      this->push(TokenType::SemiColon, s, 1);
       s++;
-      break;
+      continue;
     case '{':
-      this->push(new Token(TokenType::LCurly, "{"));
+      this->push(TokenType::LCurly, s, 1);
       s++;
-      break;
+      continue;
     case '}':
-      this->push(new Token(TokenType::RCurly, "}"));
+      this->push(TokenType::RCurly, s, 1);
       s++;
-      break;
+      continue;
     case ':':
-      this->push(new Token(TokenType::Colon, ":"));
+      this->push(TokenType::Colon, s, 1);
       s++;
-      break;
+      continue;
     case ',':
-      this->push(new Token(TokenType::Comma, ","));
+      this->push(TokenType::Comma, s, 1);
       s++;
-      break;
-
       continue;
     }
 
-    if (isspace(*s)) {
-      s++;
+    if (scan::is(*s, scan::Space)) {
+      s = scan::skip_space(s, end, line);
       continue;
     }
 
-    if (isdigit(*s)) {
-      identifier.push_back(*s);
-      while (isdigit(*(++s))) {
-        identifier.push_back(*s);
-      }
+    if (scan::is(*s, scan::Digit)) {
+      const char *start = s;
+      s = scan::skip_digits(s + 1, end);
 
-      this->push(new Token(TokenType::I32Literal, identifier));
-      identifier = "";
+      // A fraction makes it a floating point literal: `1.5`.
+      TokenType type = TokenType::I32Literal;
+      if (end - s > 1 && *s == '.' && scan::is(s[1], scan::Digit)) {
+        s = scan::skip_digits(s + 1, end);
+        type = TokenType::FloatLiteral;
+      }
 
+      this->push(type, start, s - start,
+                 interner.intern(std::string_view(start, s - start)));
       continue;
     }
 
-    if (isalnum(*s)) {
-      identifier.push_back(*s);
-      while (isalnum(*(++s))) {
-        identifier.push_back(*s);
-      }
-      if (identifier.length() > 0 && identifier != "") {
-        if (identifier == "let") {
-          this->push(new Token(TokenType::Let, identifier));
-          identifier = "";
-        } else if (identifier == "fn") {
-          this->push(new Token(TokenType::Fn, identifier));
-          identifier = "";
-        } else if (identifier == "ret") {
-          this->push(new Token(TokenType::Ret, identifier));
-          identifier = "";
-        } else if (identifier == "bool") {
-          this->push(new Token(TokenType::Type, identifier));
-          identifier = "";
-        } else if (identifier == "u8") {
-          this->push(new Token(TokenType::Type, identifier));
-          identifier = "";
-        } else if (identifier == "u16") {
-          this->push(new Token(TokenType::Type, identifier));
-          identifier = "";
-        } else if (identifier == "u32") {
-          this->push(new Token(TokenType::Type, identifier));
-          identifier = "";
-        } else if (identifier == "u64") {
-          this->push(new Token(TokenType::Type, identifier));
-          identifier = "";
-        } else if (identifier == "i8") {
-          this->push(new Token(TokenType::Type, identifier));
-          identifier = "";
-        } else if (identifier == "i16") {
-          this->push(new Token(TokenType::Type, identifier));
-          identifier = "";
-        } else if (identifier == "i32") {
-          this->push(new Token(TokenType::Type, identifier));
-          identifier = "";
-        } else if (identifier == "i64") {
-          this->push(new Token(TokenType::Type, identifier));
-          identifier = "";
-        } else if (identifier == "f32") {
-          this->push(new Token(TokenType::Type, identifier));
-          identifier = "";
-        } else if (identifier == "f64") {
-          this->push(new Token(TokenType::Type, identifier));
-          identifier = "";
-        } else if (identifier == "void") {
-          this->push(new Token(TokenType::Type, identifier));
-          identifier = "";
-        } else {
-          this->push(new Token(TokenType::Identifier, identifier));
-          identifier = "";
-        }
+    if (scan::is(*s, scan::Alpha)) {
+      const char *start = s;
+      s = scan::skip_alnum(s + 1, end);
+
+      std::string_view word(start, s - start);
+      Keyword keyword = lookup_keyword(word);
+      if (keyword == Keyword::Let) {
+        this->push(TokenType::Let, start, s - start, NoSymbol, keyword);
+      } else if (keyword == Keyword::Fn) {
+        this->push(TokenType::Fn, start, s - start, NoSymbol, keyword);
+      } else if (keyword == Keyword::Ret) {
+        this->push(TokenType::Ret, start, s - start, NoSymbol, keyword);
+      } else if (keyword == Keyword::Pub) {
+        this->push(TokenType::Pub, start, s - start, NoSymbol, keyword);
+      } else if (is_type(keyword)) {
+        this->push(TokenType::Type, start, s - start, NoSymbol, keyword);
+      } else {
+        this->push(TokenType::Identifier, start, s - start,
+                   interner.intern(word));
       }
+      continue;
     }
 
-    cc++;
+    throw CompileError(std::string("Lexing error: unexpected character '") +
+                       *s + "' at line " + std::to_string(line + 1));
   }
 
-  std::cout << "Finished parsing" << std::endl;
-
+  this->tokens.emplace_back(TokenType::None, std::string_view(s, 0));
 }
 
-Lexer::~Lexer() { delete this->head; }
-
-void Lexer::push(Token *token) {
-  if (this->head->is(TokenType::None)) {
-    this->head = token;
-    this->last = this->head;
-    return;
-  }
-
-  this->last->next = token;
-  this->last = token;
+void Lexer::push(TokenType type, const char *start, size_t length,
+                 Symbol symbol, Keyword keyword) {
+  this->tokens.emplace_back(type, std::string_view(start, length), symbol,
+                            keyword);
 }
 } // namespace tokenizer
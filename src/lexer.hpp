@@ -1,21 +1,24 @@
 #ifndef LEXER_H_
 #define LEXER_H_
 
+#include "interner.hpp"
 #include "token.hpp"
 #include <ctype.h>
-#include <string>
+#include <string_view>
+#include <vector>
 
 namespace tokenizer {
 
 class Lexer {
 public:
-  Token *head;
-Token *last;
-  Lexer(std::string source);
-  ~Lexer();
+  // Tokens in source order, always terminated by a `None` token. Lexemes
+  // point into `source`, so it must stay alive as long as the tokens do.
+  std::vector<Token> tokens;
+  Lexer(std::string_view source, Interner &interner);
 
 private:
-  void push(Token *token);
+  void push(TokenType type, const char *start, size_t length,
+            Symbol symbol = NoSymbol, Keyword keyword = Keyword::None);
 };
 
 } // namespace tokenizer
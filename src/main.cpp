@@ -1,60 +1,21 @@
-#include "lexer.hpp"
-#include "parser.hpp"
-#include "token.hpp"
-#include <fstream>
-#include <ios>
-#include <iostream>
-#include <sstream>
+#include "client.hpp"
+#include "driver.hpp"
+#include "protocol.hpp"
+#include "server.hpp"
 #include <string>
-#include "compiler.hpp"
-
-void print_ast(ast::Node *root, std::string prefix) {
-  switch (root->type) {
-  case ast::Type:
-  case ast::Invalid:
-  case ast::Identifier:
-    std::cout << prefix << "└── " << root->content << std::endl;
-    break;
-  case ast::BinaryExpr:
-  case ast::Let:
-  case ast::Integer:
-  case ast::Float:
-  case ast::Grouping:
-  case ast::Argument:
-  case ast::Fn:
-  case ast::Arguments:
-  case ast::Block:
-  case ast::Ret:
-  case ast::Call:
-  case ast::UnaryExpr:
-  case ast::Parameters:
-    std::cout << prefix << "├── " << root->content << std::endl;
-    for (ast::Node *child : root->children) {
-      print_ast(child, prefix + "|   ");
-    }
-    break;
-  }
-
-}
 
 int main(int argc, char **argv) {
+  std::string mode = argc > 1 ? argv[1] : "";
+
+  if (mode == "--server") {
+    return serve(default_socket());
+  } else if (mode.rfind("--server=", 0) == 0) {
+    return serve(mode.substr(9));
+  } else if (mode == "--connect") {
+    return connect_server(default_socket(), argc - 2, argv + 2);
+  } else if (mode.rfind("--connect=", 0) == 0) {
+    return connect_server(mode.substr(10), argc - 2, argv + 2);
+  }
 
-  std::cout << "Compiling " << argv[1] << std::endl;
-
-  std::string filename = argv[1];
-
-  std::ifstream file(filename, std::ios::in);
-  std::stringstream buf;
-  buf << file.rdbuf();
-
-  ast::Parser parser(buf.str());
-
-  std::cout << "Generating AST for: " << buf.str() << std::endl;
-
-  print_ast(parser.ast_root, "");
-
-  Compiler compiler(buf.str());
-  compiler.compile();
-
-  return 0;
+  return drive(argc, argv);
 }
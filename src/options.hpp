@@ -0,0 +1,37 @@
+#ifndef OPTIONS_H_
+#define OPTIONS_H_
+
+#include <string>
+
+enum class OptLevel { O0, O1, O2, O3, Os };
+
+// What integer `+`, `-`, `*`, `<<` and negation do when the result does not
+// fit the type. `Wrap` computes it modulo 2^bits, as two's complement
+// hardware does. With `Undefined` the program promises that it never
+// overflows: signed operations get LLVM's `nsw` flag and unsigned ones
+// `nuw`, so the optimizer may assume it when simplifying and vectorizing.
+enum class Overflow { Wrap, Undefined };
+
+// Settings for one compilation, filled in from the command line.
+struct CompileOptions {
+  OptLevel opt_level = OptLevel::O0;
+  bool dump_ast = false;
+  bool dump_ir = false;
+  std::string output = "output.o";
+  // `-march=native` targets the host CPU and its features. An explicit
+  // `-mcpu` replaces the CPU and `-mattr` features (`+avx2,-fma`) are
+  // applied on top.
+  bool native = false;
+  std::string cpu;
+  std::string features;
+  // Worker threads for code generation, 0 for one per hardware thread.
+  unsigned jobs = 0;
+  // Directory of the per-function object cache, disabled when empty.
+  std::string cache_dir;
+  Overflow overflow = Overflow::Wrap;
+  // Sets every LLVM fast-math flag on floating point operations: operands
+  // are assumed not to be NaN or infinite and may be reassociated.
+  bool fast_math = false;
+};
+
+#endif // OPTIONS_H_
@@ -1,461 +1,468 @@
 #include "parser.hpp"
-#include "lexer.hpp"
+#include "source.hpp"
 #include "token.hpp"
-#include <iostream>
-#include <ostream>
+#include <algorithm>
+#include <array>
 #include <string>
 #include <vector>
 
 namespace ast {
-Parser::Parser(std::string source) {
-  std::cout << "Generating AST" << std::endl;
-  tokenizer::Lexer lexer(source);
-  lexer.last->next = new tokenizer::Token(tokenizer::TokenType::None, "");
-  this->token_head = lexer.head;
-
-  this->ast_root = new Node();
-  ast_root->type = NodeType::Block;
-  ast_root->content = "program";
-  auto stmt = statement();
-  while (stmt->type != NodeType::Invalid) {
-    ast_root->children.push_back(stmt);
-    stmt = statement();
+Parser::Parser(const std::vector<tokenizer::Token> &tokens,
+               const Interner &interner, std::string_view source)
+    : tokens(tokens), source(source) {
+  this->ast.interner = &interner;
+  // Roughly one node per token, reserving up front avoids regrowing every
+  // array while parsing.
+  this->ast.reserve(this->tokens.size());
+  this->ast.root = this->ast.add(NodeType::Block);
+  size_t mark = this->scratch.size();
+  for (auto stmt = statement(); stmt != NoNode; stmt = statement()) {
+    this->scratch.push_back(stmt);
   }
+  finish_list(this->ast.root, mark);
+
+  if (!check(tokenizer::TokenType::None))
+    parsing_error(peek(), "Expected a statement, found " +
+                  std::string(peek().lexeme));
 }
 
-Parser::Parser(const char *source) : Parser(std::string(source)) {}
+const tokenizer::Token &Parser::peek() const {
+  return this->tokens[this->current];
+}
 
-bool Parser::check(tokenizer::TokenType type) {
-  if (!this->token_head) {
-    return false;
-  }
-  return this->token_head->is(type);
+bool Parser::check(tokenizer::TokenType type) const {
+  return peek().is(type);
 }
 
 bool Parser::consume(tokenizer::TokenType type) {
   if (check(type)) {
-    this->token_head = this->token_head->get_next();
+    advance();
     return true;
   }
 
   return false;
 }
 
-void Parser::advance() { this->token_head = this->token_head->next; }
+// The token array always ends with a `None` token, never step past it.
+void Parser::advance() {
+  if (this->current + 1 < this->tokens.size())
+    this->current++;
+}
 
-tokenizer::Token *Parser::next() {
-  tokenizer::Token *head = this->token_head;
-  this->token_head = this->token_head->get_next();
+const tokenizer::Token &Parser::next() {
+  const tokenizer::Token &head = peek();
+  advance();
   return head;
 }
 
-// Type checking
-
-enum Type Parser::evaluate_type(Node *expr) {
-  switch (expr->type) {
-    case Invalid:
-      return Type::Mismatch;
-    case BinaryExpr:
-      if (expr->content == "=") {
-        return evaluate_type(expr->children[1]);
-      } else if (expr->content == "+" || expr->content == "-" || expr->content == "*" || expr->content == "/") {
-        enum Type lhs = evaluate_type(expr->children[0]);
-        enum Type rhs = evaluate_type(expr->children[1]);
-
-        if (lhs != rhs) {
-          return Type::Mismatch;
-        }
+// Node allocation
 
-        return lhs;
-      }
-    case Grouping:
-    case UnaryExpr:
-    case Argument:
-    case Integer:
-      return evaluate_type(expr->children[0]);
-    case Fn:
-      return evaluate_type(expr->children[2]);
-    case Type:
-
-      if (expr->type == NodeType::Identifier) {
-        for (auto var : this->variables) {
-          if (var.identifier == expr->content) {
-            return var.type;
-          }
-        }
-      } else if (expr->type == NodeType::Integer) {
-        return evaluate_type(expr->children[0]);
-      }
-
-      if (expr->content == "u8") {
-        return Type::U8;
-      } else if (expr->content == "u16") {
-        return Type::U16;
-      } else if (expr->content == "u32") {
-        return Type::U32;
-      } else if (expr->content == "u64") {
-        return Type::U64;
-      } else if (expr->content == "i8") {
-        return Type::I8;
-      } else if (expr->content == "i16") {
-        return Type::I16;
-      } else if (expr->content == "i32") {
-        return Type::I32;
-      } else if (expr->content == "i64") {
-        return Type::I64;
-      } else if (expr->content == "f32") {
-        return Type::F32;
-      } else if (expr->content == "f64") {
-        return Type::F64;
-      } else if (expr->content == "bool") {
-        return Type::Bool;
-      } else {
-        return Type::Mismatch;
-      }
-    case Identifier:
-      for (auto var : this->variables) {
-        if (var.identifier == expr->content) {
-          return var.type;
-        }
-      }
-      return Type::Mismatch;
-    case Call:
-      for (auto func : this->functions) {
-        if (func.identifier == expr->content) {
-          if (func.arguments.size() != expr->children[0]->children.size()) return Type::Mismatch;
-          for (int i=0; i < func.arguments.size(); i++) {
-            auto arg = func.arguments[i];
-            if (arg.type != evaluate_type(expr->children[0]->children[i])) {
-              return Type::Mismatch;
-            }
-          }
-          return func.type;
-        }
-      }
-      return Type::Mismatch;
-    default:
-      return Type::Mismatch;
-  }
+void Parser::finish_list(NodeId parent, size_t mark) {
+  this->ast.set_children(parent, this->scratch.data() + mark,
+                         this->scratch.size() - mark);
+  this->scratch.resize(mark);
 }
 
 // Reporting
 
-void Parser::parsing_error(std::string message) {
-  std::cout << "Parsing error: " << message << std::endl;
-  exit(-1);
+void Parser::parsing_error(const tokenizer::Token &at, std::string message) {
+  std::string error = "Parsing error";
+  if (!this->source.empty()) {
+    auto location = locate(this->source, at.lexeme.data());
+    error += " at " + std::to_string(location.line) + ":" +
+             std::to_string(location.column);
+  }
+  throw CompileError(error + ": " + message);
 }
 
 // Statement parsing
 
-Node *Parser::statement() {
+NodeId Parser::statement() {
   if (consume(tokenizer::TokenType::Let)) {
     return let_statement();
   } else if (consume(tokenizer::TokenType::Ret)) {
     return ret();
   } else if (consume(tokenizer::TokenType::Fn)) {
     return function_statement();
+  } else if (consume(tokenizer::TokenType::Pub)) {
+    if (!consume(tokenizer::TokenType::Fn))
+      parsing_error(peek(), "Expected `fn` after `pub`, found " +
+                    std::string(peek().lexeme));
+    auto fn = function_statement();
+    this->ast.exports.insert(fn);
+    return fn;
   }
 
-  auto inv = new Node();
-  inv->type = NodeType::Invalid;
-  inv->content = "invalid";
-
-  return inv;
+  return NoNode;
 }
 
-Node *Parser::let_statement() {
+NodeId Parser::let_statement() {
   auto expr = expression();
-  if (expr->type != NodeType::BinaryExpr && expr->content != "=") {
-    parsing_error("Expected `assignment`, found " + expr->content);
+  if (this->ast.kind(expr) != NodeType::BinaryExpr ||
+      this->ast.op(expr) != Operator::Assign) {
+    parsing_error(peek(), "Expected `assignment`, found " +
+                  std::string(this->ast.label(expr)));
   }
 
-  auto node = new Node();
-  node->type = NodeType::Let;
-  node->content = "let";
-  node->children.push_back(expr);
+  auto node = this->ast.add(NodeType::Let, NoOp, NoSymbol, {expr});
 
   if (!consume(tokenizer::TokenType::SemiColon)) {
-    parsing_error("Expected ';', found " + this->token_head->lexeme);
+    parsing_error(peek(), "Expected ';', found " +
+                  std::string(peek().lexeme));
   }
 
-  Variable var{};
-  var.identifier = expr->children[0]->content;
-  var.type = evaluate_type(expr);
-  this->variables.push_back(var);
-
   return node;
 }
 
-Node *Parser::function_statement() {
-  auto id = next();
-  if (!id->is(tokenizer::TokenType::Identifier))
-    parsing_error("Expected `identifier`, found " + id->lexeme);
-  auto identifier = new Node();
-  identifier->type = NodeType::Identifier;
-  identifier->content = id->lexeme;
+NodeId Parser::function_statement() {
+  auto &id = next();
+  if (!id.is(tokenizer::TokenType::Identifier))
+    parsing_error(id, "Expected `identifier`, found " +
+                  std::string(id.lexeme));
+  auto identifier = this->ast.add(NodeType::Identifier, NoOp, id.symbol);
 
   auto args = arguments();
 
-  auto type = new Node();
-  type->type = NodeType::Type;
-  type->content = "void";
+  auto type = this->ast.add(NodeType::Type);
+  this->ast.types[type] = Type::Void;
 
   if (consume(tokenizer::TokenType::RightArrow)) {
-      auto tok = next();
-      if (!tok->is(tokenizer::TokenType::Type)) parsing_error("Expected `type`, found " + tok->lexeme);
-      type->content = tok->lexeme;
-  }
-
-  this->variables.clear();
-
-  Function func{};
-  func.identifier = identifier->content;
-  func.type = evaluate_type(type);
-
-  for (auto child : args->children) {
-    Variable var{};
-    var.identifier = child->content;
-    var.type = evaluate_type(child);
-    this->variables.push_back(var);
-    func.arguments.push_back(var);
+      auto &tok = next();
+      if (!tok.is(tokenizer::TokenType::Type))
+        parsing_error(tok, "Expected `type`, found " + std::string(tok.lexeme));
+      this->ast.types[type] = type_from_keyword(tok.keyword);
   }
 
-  this->functions.push_back(func);
-
   auto block = block_statement();
 
-  auto ret = new Node();
-
-  ret->type = NodeType::Fn;
-  ret->content = "fn";
-  ret->children.push_back(identifier);
-  ret->children.push_back(args);
-  ret->children.push_back(type);
-  ret->children.push_back(block);
-
-  return ret;
+  return this->ast.add(NodeType::Fn, NoOp, NoSymbol, {identifier, args, type, block});
 }
 
-Node *Parser::block_statement() {
+NodeId Parser::block_statement() {
   if (!consume(tokenizer::TokenType::LCurly))
-    parsing_error("Expected '{', found " + this->token_head->lexeme);
-
-  auto block = new Node();
-  block->type = NodeType::Block;
-  block->content = "block";
+    parsing_error(peek(), "Expected '{', found " +
+                  std::string(peek().lexeme));
 
-  auto stmt = statement();
+  auto block = this->ast.add(NodeType::Block);
 
-  while(stmt->type != NodeType::Invalid) {
-    block->children.push_back(stmt);
-    stmt = statement();
+  size_t mark = this->scratch.size();
+  for (auto stmt = statement(); stmt != NoNode; stmt = statement()) {
+    this->scratch.push_back(stmt);
   }
+  finish_list(block, mark);
 
   if (!consume(tokenizer::TokenType::RCurly))
-    parsing_error("Expected '}', found " + this->token_head->lexeme);
+    parsing_error(peek(), "Expected '}', found " +
+                  std::string(peek().lexeme));
 
   return block;
 }
 
-Node *Parser::ret() {
-  auto ret = new Node();
-  ret->type = NodeType::Ret;
-  ret->content = "ret";
-  ret->children.push_back(expression());
+NodeId Parser::ret() {
+  auto ret = this->ast.add(NodeType::Ret, NoOp, NoSymbol, {expression()});
   if (!consume(tokenizer::TokenType::SemiColon))
-    parsing_error("Expected ';', found " + this->token_head->lexeme);
+    parsing_error(peek(), "Expected ';', found " +
+                  std::string(peek().lexeme));
   return ret;
 }
 
-Node *Parser::type() {
-  auto tok = next();
-  if (!tok->is(tokenizer::TokenType::Type))
-    parsing_error("Expected `type`, found " + tok->lexeme);
-  auto ret = new Node();
-  ret->type = NodeType::Type;
-  ret->content = tok->lexeme;
+NodeId Parser::type() {
+  auto &tok = next();
+  if (!tok.is(tokenizer::TokenType::Type))
+    parsing_error(tok, "Expected `type`, found " +
+                  std::string(tok.lexeme));
 
+  auto ret = this->ast.add(NodeType::Type);
+  this->ast.types[ret] = type_from_keyword(tok.keyword);
   return ret;
 }
 
 // Function utilities
 
-Node *Parser::argument() {
-  auto id = next();
-  if (!id->is(tokenizer::TokenType::Identifier))
-    parsing_error("Expected `identifier`, found " + id->lexeme);
-  auto identifier = new Node();
-  identifier->type = NodeType::Identifier;
-  identifier->content = id->lexeme;
+NodeId Parser::argument() {
+  auto &id = next();
+  if (!id.is(tokenizer::TokenType::Identifier))
+    parsing_error(id, "Expected `identifier`, found " +
+                  std::string(id.lexeme));
+  auto symbol = id.symbol;
   if (!consume(tokenizer::TokenType::Colon))
-    parsing_error("Expected ':', found " + this->token_head->lexeme);
+    parsing_error(peek(), "Expected ':', found " +
+                  std::string(peek().lexeme));
   auto type = this->type();
 
-  auto arg = new Node();
-  arg->type = NodeType::Argument;
-  arg->content = identifier->content;
-  arg->children.push_back(type);
-
-  return arg;
+  return this->ast.add(NodeType::Argument, NoOp, symbol, {type});
 }
 
-Node *Parser::arguments() {
+NodeId Parser::arguments() {
   if (!consume(tokenizer::TokenType::LParen))
-    parsing_error("Expected '(', found " + this->token_head->lexeme);
+    parsing_error(peek(), "Expected '(', found " +
+                  std::string(peek().lexeme));
+
+  auto ret = this->ast.add(NodeType::Arguments);
   if (consume(tokenizer::TokenType::RParen)) {
-    auto ret = new Node();
-    ret->type = NodeType::Arguments;
-    ret->content = "args";
     return ret;
   }
 
-  auto ret = new Node();
-  ret->type = NodeType::Arguments;
-
-  auto arg = argument();
-  ret->children.push_back(arg);
+  size_t mark = this->scratch.size();
+  this->scratch.push_back(argument());
 
   while (consume(tokenizer::TokenType::Comma)) {
-    auto arg = argument();
-    ret->children.push_back(arg);
+    this->scratch.push_back(argument());
   }
 
-  ret->content = "args";
+  finish_list(ret, mark);
 
   if (!consume(tokenizer::TokenType::RParen))
-    parsing_error("Expected ')', found " + this->token_head->lexeme);
+    parsing_error(peek(), "Expected ')', found " +
+                  std::string(peek().lexeme));
 
   return ret;
 }
 
 // Expression parsing
 
-Node *Parser::expression() {
-  auto res = assignment();
-  if (evaluate_type(res) == Type::Mismatch) {
-    parsing_error("Mismatched types!");
-  }
-  return res;
+namespace {
+
+struct BinaryOperator {
+  Operator op;
+  // 0 for tokens that are not binary operators, higher binds tighter.
+  uint8_t precedence;
+  bool right_associative;
+};
+
+constexpr uint8_t prefix_precedence = 12;
+
+constexpr std::array<BinaryOperator, tokenizer::token_type_count>
+build_binary_operators() {
+  std::array<BinaryOperator, tokenizer::token_type_count> table{};
+  table[tokenizer::Equal] = {Assign, 1, true};
+  table[tokenizer::PipePipe] = {Or, 2, false};
+  table[tokenizer::AmpAmp] = {And, 3, false};
+  table[tokenizer::Pipe] = {BitOr, 4, false};
+  table[tokenizer::Caret] = {BitXor, 5, false};
+  table[tokenizer::Amp] = {BitAnd, 6, false};
+  table[tokenizer::EqualEqual] = {Eq, 7, false};
+  table[tokenizer::BangEqual] = {Ne, 7, false};
+  table[tokenizer::Less] = {Lt, 8, false};
+  table[tokenizer::LessEqual] = {Le, 8, false};
+  table[tokenizer::Greater] = {Gt, 8, false};
+  table[tokenizer::GreaterEqual] = {Ge, 8, false};
+  table[tokenizer::LessLess] = {Shl, 9, false};
+  table[tokenizer::GreaterGreater] = {Shr, 9, false};
+  table[tokenizer::Plus] = {Add, 10, false};
+  table[tokenizer::Minus] = {Sub, 10, false};
+  table[tokenizer::Star] = {Mul, 11, false};
+  table[tokenizer::Slash] = {Div, 11, false};
+  return table;
 }
 
-Node *Parser::assignment() {
-  Node *res = term();
-
-  if (check(tokenizer::TokenType::Equal)) {
-    Node *new_node = new Node();
-    new_node->content = this->token_head->lexeme;
-    new_node->type = NodeType::BinaryExpr;
-    advance();
-    Node *rhs = term();
-    new_node->children.push_back(res);
-    new_node->children.push_back(rhs);
-    res = new_node;
+// Levels of nesting an expression may have, counting every operator,
+// parenthesis and call. Later passes recurse once per level; this is a
+// quarter of what they were seen to handle on an 8 MiB stack.
+constexpr uint32_t max_expression_depth = 10000;
+
+constexpr auto binary_operators = build_binary_operators();
+
+Operator prefix_operator(tokenizer::TokenType type) {
+  switch (type) {
+  case tokenizer::Minus:
+    return Negate;
+  case tokenizer::Bang:
+    return Not;
+  case tokenizer::Tilde:
+    return BitNot;
+  default:
+    return NoOp;
   }
-
-  return res;
 }
 
-Node *Parser::term() {
-  Node *res = factor();
-
-  while (check(tokenizer::TokenType::Plus) ||
-         check(tokenizer::TokenType::Minus)) {
+} // namespace
+
+// Operator precedence parsing over explicit operand and operator stacks. The
+// loop alternates between reading an operand, with any prefix operators,
+// open parentheses and call heads in front of it, and reading the operator
+// that follows. Operators of higher precedence than the incoming one are
+// reduced into nodes first, and `)` or `,` reduce down to the group or call
+// they close.
+NodeId Parser::expression() {
+  size_t base = this->operators.size();
+
+  for (;;) {
+    // Operand
+    for (;;) {
+      auto &tok = peek();
+      if (auto op = prefix_operator(tok.type); op != NoOp) {
+        this->operators.push_back(
+            {Pending::Prefix, op, prefix_precedence, NoSymbol, 0});
+        advance();
+      } else if (tok.is(tokenizer::TokenType::LParen)) {
+        this->operators.push_back({Pending::Group, NoOp, 0, NoSymbol, 0});
+        advance();
+      } else if (tok.is(tokenizer::TokenType::Identifier) &&
+                 this->tokens[this->current + 1].is(
+                     tokenizer::TokenType::LParen)) {
+        this->operators.push_back(
+            {Pending::Call, NoOp, 0, tok.symbol,
+             static_cast<uint32_t>(this->operands.size())});
+        advance();
+        advance();
+        if (!check(tokenizer::TokenType::RParen))
+          continue;
+        // No arguments, the call is complete. Closing it below finds it on
+        // top of the stack.
+        break;
+      } else {
+        this->operands.push_back(atom());
+        this->heights.push_back(0);
+        break;
+      }
+    }
 
-    Node *new_node = new Node();
-    new_node->content = this->token_head->lexeme;
-    new_node->type = NodeType::BinaryExpr;
-    advance();
-    Node *rhs = factor();
-    new_node->children.push_back(res);
-    new_node->children.push_back(rhs);
-    res = new_node;
-  }
+    // Operator
+    for (;;) {
+      auto &tok = peek();
+      auto binary = binary_operators[tok.type];
+      if (binary.precedence > 0) {
+        while (this->operators.size() > base) {
+          auto &top = this->operators.back();
+          if (top.kind == Pending::Group || top.kind == Pending::Call ||
+              top.precedence < binary.precedence ||
+              (top.precedence == binary.precedence &&
+               binary.right_associative))
+            break;
+          reduce_one();
+        }
+        this->operators.push_back(
+            {Pending::Binary, binary.op, binary.precedence, NoSymbol, 0});
+        advance();
+        break;
+      }
 
-  return res;
-}
+      bool closes = tok.is(tokenizer::TokenType::RParen) ||
+                    tok.is(tokenizer::TokenType::Comma);
+      reduce(base);
+      if (!closes || this->operators.size() == base) {
+        // The expression ends here; any group or call still open is missing
+        // its `)`.
+        if (this->operators.size() > base) {
+          parsing_error(tok, "Expected ')', found " + std::string(tok.lexeme));
+        }
+        NodeId result = this->operands.back();
+        this->operands.pop_back();
+        this->heights.pop_back();
+        return result;
+      }
 
-Node *Parser::factor() {
-  Node *res = unary();
+      auto frame = this->operators.back();
+      if (frame.kind == Pending::Group) {
+        if (!tok.is(tokenizer::TokenType::RParen))
+          parsing_error(tok, "Expected ')', found " + std::string(tok.lexeme));
+        advance();
+        this->operators.pop_back();
+        this->operands.back() = this->ast.add(NodeType::Grouping, NoOp,
+                                              NoSymbol, {this->operands.back()});
+        this->heights.back() = nest(this->heights.back() + 1);
+        continue;
+      }
 
-  while (check(tokenizer::TokenType::Star) ||
-         check(tokenizer::TokenType::Slash)) {
-    Node *new_node = new Node();
-    new_node->content = this->token_head->lexeme;
-    new_node->type = NodeType::BinaryExpr;
-    advance();
-    Node *rhs = unary();
-    new_node->children.push_back(res);
-    new_node->children.push_back(rhs);
-    res = new_node;
+      // Call: either the next argument follows or the call is complete.
+      advance();
+      if (tok.is(tokenizer::TokenType::Comma))
+        break;
+      this->operators.pop_back();
+      auto params = this->ast.add(NodeType::Parameters);
+      this->ast.set_children(params, this->operands.data() + frame.mark,
+                             this->operands.size() - frame.mark);
+      uint32_t deepest = 0;
+      for (size_t i = frame.mark; i < this->heights.size(); i++) {
+        deepest = std::max(deepest, this->heights[i]);
+      }
+      this->operands.resize(frame.mark);
+      this->heights.resize(frame.mark);
+      this->operands.push_back(
+          this->ast.add(NodeType::Call, NoOp, frame.symbol, {params}));
+      // Parameters and Call.
+      this->heights.push_back(nest(deepest + 2));
+    }
   }
+}
 
-  return res;
+// Reduces every pending operator above `base` up to the innermost open
+// group or call.
+void Parser::reduce(size_t base) {
+  while (this->operators.size() > base) {
+    auto kind = this->operators.back().kind;
+    if (kind == Pending::Group || kind == Pending::Call)
+      return;
+    reduce_one();
+  }
 }
 
-Node *Parser::unary() {
-  if (check(tokenizer::TokenType::Minus)) {
-    advance();
-    Node *new_node = new Node();
-    new_node->children.push_back(primary());
-    new_node->content = "-";
-    new_node->type = NodeType::UnaryExpr;
-    return new_node;
+void Parser::reduce_one() {
+  auto pending = this->operators.back();
+  this->operators.pop_back();
+  NodeId rhs = this->operands.back();
+  this->operands.pop_back();
+  if (pending.kind == Pending::Prefix) {
+    this->operands.push_back(
+        this->ast.add(NodeType::UnaryExpr, pending.op, NoSymbol, {rhs}));
+    this->heights.back() = nest(this->heights.back() + 1);
   } else {
-    return primary();
+    NodeId lhs = this->operands.back();
+    this->operands.back() =
+        this->ast.add(NodeType::BinaryExpr, pending.op, NoSymbol, {lhs, rhs});
+    uint32_t rhs_height = this->heights.back();
+    this->heights.pop_back();
+    this->heights.back() = nest(std::max(this->heights.back(), rhs_height) + 1);
   }
 }
 
-Node *Parser::primary() {
-  tokenizer::Token *tok = next();
-  Node *node = new Node();
+// Returns the height of a new expression node, rejecting it if the
+// expression has become too deep.
+uint32_t Parser::nest(uint32_t height) {
+  if (height > max_expression_depth) {
+    parsing_error(peek(), "Expression nested more than " +
+                              std::to_string(max_expression_depth) +
+                              " levels deep");
+  }
+  return height;
+}
 
-  if (tok->is(tokenizer::TokenType::I32Literal)) {
-    node->type = NodeType::Integer;
-    node->content = tok->lexeme;
-    auto type = new Node();
-    type->type = NodeType::Type;
-    type->content = "i32";
+// Literals and variables, everything else is handled by `expression`.
+NodeId Parser::atom() {
+  auto &tok = next();
+  if (tok.is(tokenizer::TokenType::I32Literal)) {
+    auto node = this->ast.add(NodeType::Integer, NoOp,
+                              tok.symbol);
+    this->ast.types[node] = Type::I32;
 
     if (check(tokenizer::TokenType::Type)) {
-      type->content = this->token_head->lexeme;
+      this->ast.types[node] = type_from_keyword(peek().keyword);
       advance();
     }
 
-    node->children.push_back(type);
-  } else if (tok->is(tokenizer::TokenType::LParen)) {
-    auto expr = expression();
-    consume(tokenizer::TokenType::RParen);
-    node->type = NodeType::Grouping;
-    node->content = "group";
-    node->children.push_back(expr);
-  } else if (tok->is(tokenizer::TokenType::Identifier)) {
-    if (check(tokenizer::TokenType::LParen)) {
-      advance();
-      auto params = new Node();
-      params->type = NodeType::Parameters;
-      params->content = "params";
-
-      if (!check(tokenizer::TokenType::RParen)) {
-        params->children.push_back(expression());
+    return node;
+  } else if (tok.is(tokenizer::TokenType::FloatLiteral)) {
+    auto node = this->ast.add(NodeType::Float, NoOp, tok.symbol);
+    this->ast.types[node] = Type::F64;
 
-        while (consume(tokenizer::TokenType::Comma)) {
-          params->children.push_back(expression());
-        }
+    if (check(tokenizer::TokenType::Type)) {
+      auto type = type_from_keyword(peek().keyword);
+      if (!is_float(type)) {
+        parsing_error(peek(), "Expected a floating point type, found " +
+                                  std::string(peek().lexeme));
       }
-
-      if (!consume(tokenizer::TokenType::RParen))
-        parsing_error("Expected ')', found " + this->token_head->lexeme);
-      node->type = NodeType::Call;
-      node->content = tok->lexeme;
-      node->children.push_back(params);
-    } else {
-      node->type = NodeType::Identifier;
-      node->content = tok->lexeme;
+      this->ast.types[node] = type;
+      advance();
     }
-  } else {
-    parsing_error("Expected `primary`, found " + tok->lexeme);
+
+    return node;
+  } else if (tok.is(tokenizer::TokenType::Identifier)) {
+    return this->ast.add(NodeType::Identifier, NoOp, tok.symbol);
   }
 
-  return node;
+  parsing_error(tok, "Expected `primary`, found " +
+                  std::string(tok.lexeme));
+  return NoNode;
 }
 } // namespace ast
@@ -1,91 +1,80 @@
 #ifndef PARSER_H_
 #define PARSER_H_
 
+#include "ast.hpp"
 #include "token.hpp"
 #include <string>
+#include <string_view>
 #include <vector>
 namespace ast {
 
-enum Type { Mismatch = -1, U8, U16, U32, U64, I8, I16, I32, I64, F32, F64, Bool };
-
-enum NodeType {
-  Invalid = -1,
-  BinaryExpr,
-  UnaryExpr,
-  Call,
-  Parameters,
-  Integer,
-  Float,
-  Grouping,
-  Let,
-  Identifier,
-  Fn,
-  Arguments,
-  Argument,
-  Type,
-  Block,
-  Ret,
-};
-
-struct Variable {
-  std::string identifier;
-  enum Type type;
-};
-
-struct Function {
-  std::string identifier;
-  std::vector<Variable> arguments;
-  enum Type type;
-};
-
-class Node {
-public:
-  NodeType type;
-  std::string content;
-  std::vector<Node *> children;
-};
-
 class Parser {
 public:
-  Parser(std::string source);
-  Parser(const char *source);
-  tokenizer::Token *token_head;
-  Node *ast_root;
-  std::vector<Variable> variables;
-  std::vector<Function> functions;
+  // Builds the AST from a `None`-terminated token array, which has to outlive
+  // the parser. Symbols in the AST refer to `interner`. When given, the
+  // source the tokens point into is used to locate errors.
+  Parser(const std::vector<tokenizer::Token> &tokens, const Interner &interner,
+         std::string_view source = {});
+  const std::vector<tokenizer::Token> &tokens;
+  std::string_view source;
+  size_t current = 0;
+  Ast ast;
 
 private:
-  // Type checking
-  enum Type evaluate_type(Node *expr);
+  // Node allocation
+  void finish_list(NodeId parent, size_t mark);
 
   // Reporting
-  void parsing_error(std::string message);
+  void parsing_error(const tokenizer::Token &at, std::string message);
 
   // Tokens utilities
-  bool check(tokenizer::TokenType type);
+  const tokenizer::Token &peek() const;
+  bool check(tokenizer::TokenType type) const;
   bool consume(tokenizer::TokenType type);
   void advance();
-  tokenizer::Token *next();
+  const tokenizer::Token &next();
 
   // Statement parsing
-  Node *statement();
-  Node *let_statement();
-  Node *function_statement();
-  Node *block_statement();
-  Node *type();
-  Node *ret();
+  NodeId statement();
+  NodeId let_statement();
+  NodeId function_statement();
+  NodeId block_statement();
+  NodeId type();
+  NodeId ret();
 
   // Functions utilities
-  Node *argument();
-  Node *arguments();
+  NodeId argument();
+  NodeId arguments();
 
   // Expression parsing
-  Node *expression();
-  Node *assignment();
-  Node *term();
-  Node *factor();
-  Node *unary();
-  Node *primary();
+  NodeId expression();
+  NodeId atom();
+  void reduce(size_t base);
+  void reduce_one();
+  uint32_t nest(uint32_t height);
+
+  // Children of the lists being parsed, innermost list on top. A list is
+  // moved into the AST once complete so that it is stored contiguously.
+  std::vector<NodeId> scratch;
+
+  // Operators waiting for their operands, and the open parentheses and
+  // calls they are nested in. Keeping these on explicit stacks keeps parsing
+  // off the native stack; nesting is still limited to
+  // `max_expression_depth` because later passes recurse.
+  struct Pending {
+    enum Kind : uint8_t { Binary, Prefix, Group, Call } kind;
+    Operator op;
+    uint8_t precedence;
+    Symbol symbol;
+    // Operand stack height when a call was opened, its arguments are above.
+    uint32_t mark;
+  };
+  std::vector<Pending> operators;
+  std::vector<NodeId> operands;
+  // Height of the subtree of each operand, 0 for leaves. The type checker,
+  // simplifier and code generator walk expressions recursively, so nesting
+  // is capped well below what their stacks can hold.
+  std::vector<uint32_t> heights;
 };
 } // namespace ast
 
@@ -0,0 +1,46 @@
+#include "pipeline.hpp"
+#include "checker.hpp"
+#include "compiler.hpp"
+#include "lexer.hpp"
+#include "simplifier.hpp"
+#include "timing.hpp"
+#include <iostream>
+
+Pipeline::Pipeline(std::string_view source) : source(source) {}
+
+void Pipeline::lex() {
+  PhaseTimer timer(Phase::Lex);
+  tokenizer::Lexer lexer(this->source, this->interner);
+  this->tokens = std::move(lexer.tokens);
+}
+
+void Pipeline::parse() {
+  PhaseTimer timer(Phase::Parse);
+  this->parser = std::make_unique<ast::Parser>(this->tokens, this->interner,
+                                                this->source);
+  if (this->options.dump_ast) {
+    ast::print_ast(std::cout, this->ast(), this->ast().root);
+  }
+}
+
+void Pipeline::check() {
+  PhaseTimer timer(Phase::Check);
+  ast::TypeChecker checker(this->parser->ast);
+  checker.check();
+}
+
+void Pipeline::simplify() {
+  PhaseTimer timer(Phase::Simplify);
+  ast::Simplifier simplifier(this->parser->ast, this->interner);
+  simplifier.simplify();
+}
+
+int Pipeline::run(ThreadPool &pool) {
+  Compiler compiler(this->ast(), this->options, pool);
+  return compiler.run();
+}
+
+void Pipeline::compile(ThreadPool &pool) {
+  Compiler compiler(this->ast(), this->options, pool);
+  compiler.compile();
+}
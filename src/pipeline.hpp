@@ -0,0 +1,42 @@
+#ifndef PIPELINE_H_
+#define PIPELINE_H_
+
+#include "ast.hpp"
+#include "interner.hpp"
+#include "options.hpp"
+#include "parser.hpp"
+#include "thread_pool.hpp"
+#include "token.hpp"
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// Runs one source file through the front end and code generation. Each stage
+// consumes the result of the previous one, so the source is lexed and parsed
+// exactly once.
+class Pipeline {
+public:
+  // `source` is borrowed and must outlive the pipeline.
+  explicit Pipeline(std::string_view source);
+
+  void lex();
+  void parse();
+  void check();
+  // Folds constants and removes identities; needs the types from `check`.
+  void simplify();
+  // Code generation runs on `pool`, shared by every file of a batch.
+  void compile(ThreadPool &pool);
+  int run(ThreadPool &pool);
+
+  const ast::Ast &ast() const { return this->parser->ast; }
+
+  CompileOptions options;
+
+private:
+  std::string_view source;
+  Interner interner;
+  std::vector<tokenizer::Token> tokens;
+  std::unique_ptr<ast::Parser> parser;
+};
+
+#endif // PIPELINE_H_
@@ -0,0 +1,67 @@
+#include "protocol.hpp"
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <unistd.h>
+
+std::string default_socket() {
+  if (auto runtime = getenv("XDG_RUNTIME_DIR")) {
+    return std::string(runtime) + "/brom.sock";
+  }
+  return "/tmp/brom-" + std::to_string(getuid()) + ".sock";
+}
+
+bool write_all(int fd, const void *data, size_t size) {
+  auto bytes = static_cast<const char *>(data);
+  while (size > 0) {
+    ssize_t written = write(fd, bytes, size);
+    if (written < 0 && errno == EINTR)
+      continue;
+    if (written <= 0)
+      return false;
+    bytes += written;
+    size -= written;
+  }
+  return true;
+}
+
+bool read_all(int fd, void *data, size_t size) {
+  auto bytes = static_cast<char *>(data);
+  while (size > 0) {
+    ssize_t got = read(fd, bytes, size);
+    if (got < 0 && errno == EINTR)
+      continue;
+    if (got <= 0)
+      return false;
+    bytes += got;
+    size -= got;
+  }
+  return true;
+}
+
+bool write_u32(int fd, uint32_t value) {
+  value = htonl(value);
+  return write_all(fd, &value, sizeof(value));
+}
+
+bool read_u32(int fd, uint32_t &value) {
+  if (!read_all(fd, &value, sizeof(value)))
+    return false;
+  value = ntohl(value);
+  return true;
+}
+
+sockaddr_un socket_address(const std::string &path) {
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(address.sun_path)) {
+    std::cerr << "Socket path too long: " << path << std::endl;
+    exit(-1);
+  }
+  strcpy(address.sun_path, path.c_str());
+  return address;
+}
+
@@ -0,0 +1,26 @@
+#ifndef PROTOCOL_H_
+#define PROTOCOL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <sys/un.h>
+
+// Wire format between `brom --server` and its clients. A request is a 32-bit
+// count of strings, then the working directory and the command line, each
+// as a 32-bit length and its bytes. The reply is the merged stdout and
+// stderr of the compilation, followed by its exit code as the last four
+// bytes. Integers are big-endian.
+
+// `$XDG_RUNTIME_DIR/brom.sock`, or `/tmp/brom-<uid>.sock` without it.
+std::string default_socket();
+
+sockaddr_un socket_address(const std::string &path);
+
+// Retry short reads and writes; false on error or end of file.
+bool write_all(int fd, const void *data, size_t size);
+bool read_all(int fd, void *data, size_t size);
+bool write_u32(int fd, uint32_t value);
+bool read_u32(int fd, uint32_t &value);
+
+#endif // PROTOCOL_H_
@@ -0,0 +1,184 @@
+#ifndef SCAN_H_
+#define SCAN_H_
+
+#include <array>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Character classification and run scanning for the lexer. Runs of
+// whitespace, digits and identifier characters are skipped 16 bytes at a time
+// with SSE2, or 32 with AVX2 when the build enables it, and byte by byte
+// through a lookup table otherwise and for the tail of the input.
+namespace tokenizer::scan {
+
+enum CharClass : uint8_t { Other = 0, Space = 1, Digit = 2, Alpha = 4 };
+
+constexpr std::array<uint8_t, 256> build_classes() {
+  std::array<uint8_t, 256> classes{};
+  for (int c = '\t'; c <= '\r'; c++)
+    classes[c] = Space;
+  classes[' '] = Space;
+  for (int c = '0'; c <= '9'; c++)
+    classes[c] = Digit;
+  for (int c = 'a'; c <= 'z'; c++)
+    classes[c] = Alpha;
+  for (int c = 'A'; c <= 'Z'; c++)
+    classes[c] = Alpha;
+  return classes;
+}
+
+constexpr std::array<uint8_t, 256> classes = build_classes();
+
+inline bool is(char c, uint8_t mask) {
+  return classes[static_cast<unsigned char>(c)] & mask;
+}
+
+// Scalar versions, also used for the last few bytes of the vector scans.
+
+inline const char *skip_scalar(const char *s, const char *end, uint8_t mask) {
+  while (s < end && is(*s, mask))
+    s++;
+  return s;
+}
+
+inline const char *skip_space_scalar(const char *s, const char *end,
+                                     int &lines) {
+  while (s < end && is(*s, Space)) {
+    lines += *s == '\n';
+    s++;
+  }
+  return s;
+}
+
+#if defined(__AVX2__)
+
+constexpr int width = 32;
+using Vector = __m256i;
+
+inline Vector load(const char *s) {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s));
+}
+inline Vector splat(char c) { return _mm256_set1_epi8(c); }
+inline Vector sub(Vector a, Vector b) { return _mm256_sub_epi8(a, b); }
+inline Vector eq(Vector a, Vector b) { return _mm256_cmpeq_epi8(a, b); }
+inline Vector either(Vector a, Vector b) { return _mm256_or_si256(a, b); }
+inline Vector min(Vector a, Vector b) { return _mm256_min_epu8(a, b); }
+inline uint32_t bits(Vector v) { return _mm256_movemask_epi8(v); }
+
+#elif defined(__SSE2__)
+
+constexpr int width = 16;
+using Vector = __m128i;
+
+inline Vector load(const char *s) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i *>(s));
+}
+inline Vector splat(char c) { return _mm_set1_epi8(c); }
+inline Vector sub(Vector a, Vector b) { return _mm_sub_epi8(a, b); }
+inline Vector eq(Vector a, Vector b) { return _mm_cmpeq_epi8(a, b); }
+inline Vector either(Vector a, Vector b) { return _mm_or_si128(a, b); }
+inline Vector min(Vector a, Vector b) { return _mm_min_epu8(a, b); }
+inline uint32_t bits(Vector v) { return _mm_movemask_epi8(v); }
+
+#endif
+
+#if defined(__AVX2__) || defined(__SSE2__)
+
+constexpr uint32_t all = width == 32 ? 0xFFFFFFFFu : 0xFFFFu;
+
+// Lanes where `lo <= c <= lo + span`, as an unsigned compare.
+inline Vector in_range(Vector c, char lo, char span) {
+  Vector offset = sub(c, splat(lo));
+  return eq(min(offset, splat(span)), offset);
+}
+
+inline Vector space_lanes(Vector c) {
+  return either(eq(c, splat(' ')), in_range(c, '\t', '\r' - '\t'));
+}
+
+inline Vector digit_lanes(Vector c) { return in_range(c, '0', 9); }
+
+inline Vector alnum_lanes(Vector c) {
+  return either(digit_lanes(c), in_range(either(c, splat(0x20)), 'a', 25));
+}
+
+// Most runs are short: a single space between tokens, or a name of a few
+// characters. The first `prologue` bytes are checked one at a time before
+// paying for a vector load.
+constexpr int prologue = 8;
+
+inline const char *skip_space(const char *s, const char *end, int &lines) {
+  for (int i = 0; i < prologue; i++, s++) {
+    if (s == end || !is(*s, Space))
+      return s;
+    lines += *s == '\n';
+  }
+  while (end - s >= width) {
+    Vector c = load(s);
+    uint32_t rest = ~bits(space_lanes(c)) & all;
+    uint32_t newlines = bits(eq(c, splat('\n')));
+    if (rest) {
+      uint32_t run = __builtin_ctz(rest);
+      lines += __builtin_popcount(newlines & ((1u << run) - 1));
+      return s + run;
+    }
+    lines += __builtin_popcount(newlines);
+    s += width;
+  }
+  return skip_space_scalar(s, end, lines);
+}
+
+inline const char *skip_digits(const char *s, const char *end) {
+  for (int i = 0; i < prologue; i++, s++) {
+    if (s == end || !is(*s, Digit))
+      return s;
+  }
+  while (end - s >= width) {
+    uint32_t rest = ~bits(digit_lanes(load(s))) & all;
+    if (rest)
+      return s + __builtin_ctz(rest);
+    s += width;
+  }
+  return skip_scalar(s, end, Digit);
+}
+
+inline const char *skip_alnum(const char *s, const char *end) {
+  for (int i = 0; i < prologue; i++, s++) {
+    if (s == end || !is(*s, Digit | Alpha))
+      return s;
+  }
+  while (end - s >= width) {
+    uint32_t rest = ~bits(alnum_lanes(load(s))) & all;
+    if (rest)
+      return s + __builtin_ctz(rest);
+    s += width;
+  }
+  return skip_scalar(s, end, Digit | Alpha);
+}
+
+#else
+
+constexpr int width = 1;
+
+inline const char *skip_space(const char *s, const char *end, int &lines) {
+  return skip_space_scalar(s, end, lines);
+}
+
+inline const char *skip_digits(const char *s, const char *end) {
+  return skip_scalar(s, end, Digit);
+}
+
+inline const char *skip_alnum(const char *s, const char *end) {
+  return skip_scalar(s, end, Digit | Alpha);
+}
+
+#endif
+
+} // namespace tokenizer::scan
+
+#endif // SCAN_H_
@@ -0,0 +1,181 @@
+#include "server.hpp"
+#include "protocol.hpp"
+#include "driver.hpp"
+#include "options.hpp"
+#include "target.hpp"
+#include "thread_pool.hpp"
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <limits.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+int signal_pipe[2];
+
+void on_signal(int signal) {
+  char byte = signal == SIGCHLD ? 'c' : 'q';
+  int saved = errno;
+  (void)!write(signal_pipe[1], &byte, 1);
+  errno = saved;
+}
+
+// Runs in the forked child: reads the request, points stdout and stderr at
+// the connection and compiles.
+[[noreturn]] void handle(int connection) {
+  uint32_t count;
+  std::vector<std::string> strings;
+  if (read_u32(connection, count)) {
+    for (uint32_t i = 0; i < count; i++) {
+      uint32_t length;
+      if (!read_u32(connection, length))
+        break;
+      std::string string(length, '\0');
+      if (!read_all(connection, string.data(), length))
+        break;
+      strings.push_back(std::move(string));
+    }
+  }
+  if (strings.size() < 2 || strings.size() != count) {
+    _exit(-1);
+  }
+
+  dup2(connection, STDOUT_FILENO);
+  dup2(connection, STDERR_FILENO);
+  close(connection);
+
+  if (chdir(strings[0].c_str()) != 0) {
+    std::cerr << "Could not enter " << strings[0] << ": " << strerror(errno)
+              << std::endl;
+    exit(-1);
+  }
+
+  std::vector<char *> argv;
+  for (size_t i = 1; i < strings.size(); i++) {
+    argv.push_back(strings[i].data());
+  }
+  argv.push_back(nullptr);
+  exit(drive(argv.size() - 1, argv.data()));
+}
+
+} // namespace
+
+int serve(const std::string &path) {
+  // Pay for target setup once, the children inherit it: a machine for every
+  // thread a request's pool can run, for each -O level on the generic and
+  // the host CPU.
+  unsigned threads = ThreadPool::concurrency(0);
+  for (bool native : {false, true}) {
+    for (auto level : {OptLevel::O0, OptLevel::O1, OptLevel::O2, OptLevel::O3,
+                       OptLevel::Os}) {
+      CompileOptions options;
+      options.native = native;
+      options.opt_level = level;
+      warm_target_machines(resolve_target(options), threads);
+    }
+  }
+
+  auto address = socket_address(path);
+  int listener = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  unlink(path.c_str());
+  if (listener < 0 ||
+      bind(listener, reinterpret_cast<sockaddr *>(&address),
+           sizeof(address)) != 0 ||
+      listen(listener, 64) != 0) {
+    std::cerr << "Could not listen on " << path << ": " << strerror(errno)
+              << std::endl;
+    exit(-1);
+  }
+  chmod(path.c_str(), 0600);
+
+  if (pipe2(signal_pipe, O_CLOEXEC | O_NONBLOCK) != 0) {
+    std::cerr << "Could not create pipe: " << strerror(errno) << std::endl;
+    exit(-1);
+  }
+  struct sigaction action {};
+  action.sa_handler = on_signal;
+  action.sa_flags = SA_RESTART;
+  sigaction(SIGCHLD, &action, nullptr);
+  sigaction(SIGINT, &action, nullptr);
+  sigaction(SIGTERM, &action, nullptr);
+  signal(SIGPIPE, SIG_IGN);
+
+  std::cout << "Listening on " << path << std::endl;
+
+  // Connection of every running request, answered once its child exits.
+  std::unordered_map<pid_t, int> requests;
+  bool stopping = false;
+  while (!stopping || !requests.empty()) {
+    pollfd fds[2] = {{signal_pipe[0], POLLIN, 0},
+                     {listener, stopping ? short(0) : short(POLLIN), 0}};
+    if (poll(fds, 2, -1) < 0) {
+      if (errno == EINTR)
+        continue;
+      break;
+    }
+
+    if (fds[0].revents & POLLIN) {
+      char byte;
+      while (read(signal_pipe[0], &byte, 1) == 1) {
+        stopping |= byte == 'q';
+      }
+      int status;
+      pid_t pid;
+      while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+        auto request = requests.find(pid);
+        if (request == requests.end())
+          continue;
+        int code = WIFEXITED(status) ? WEXITSTATUS(status)
+                                     : 128 + WTERMSIG(status);
+        write_u32(request->second, code);
+        close(request->second);
+        requests.erase(request);
+      }
+    }
+
+    if (fds[1].revents & POLLIN) {
+      int connection = accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+      if (connection < 0)
+        continue;
+      pid_t pid = fork();
+      if (pid == 0) {
+        signal(SIGCHLD, SIG_DFL);
+        signal(SIGINT, SIG_DFL);
+        signal(SIGTERM, SIG_DFL);
+        signal(SIGPIPE, SIG_DFL);
+        close(listener);
+        // Other clients must see their connection close with their child.
+        for (auto &request : requests) {
+          close(request.second);
+        }
+        close(signal_pipe[0]);
+        close(signal_pipe[1]);
+        handle(connection);
+      }
+      if (pid < 0) {
+        write_u32(connection, 255);
+        close(connection);
+        continue;
+      }
+      requests[pid] = connection;
+    }
+  }
+
+  close(listener);
+  unlink(path.c_str());
+  return 0;
+}
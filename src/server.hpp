@@ -0,0 +1,13 @@
+#ifndef SERVER_H_
+#define SERVER_H_
+
+#include <string>
+
+// Listens on the Unix socket at `path` and compiles every request with a
+// fork of the warmed-up server. LLVM is initialized and the target resolved
+// once, before the first request; each request then runs in a child that
+// exits when it is done, so none of its AST or module memory stays behind
+// in the server and an error in one request cannot take the server down.
+int serve(const std::string &path);
+
+#endif // SERVER_H_
@@ -0,0 +1,284 @@
+#include "simplifier.hpp"
+#include <cerrno>
+#include <cstdlib>
+#include <string>
+
+namespace ast {
+
+namespace {
+
+// Bits of an integer or boolean type; 0 for the types that are not folded.
+int width(enum Type type) {
+  switch (type) {
+  case Type::U8:
+  case Type::I8:
+    return 8;
+  case Type::U16:
+  case Type::I16:
+    return 16;
+  case Type::U32:
+  case Type::I32:
+    return 32;
+  case Type::U64:
+  case Type::I64:
+    return 64;
+  case Type::Bool:
+    return 1;
+  default:
+    return 0;
+  }
+}
+
+// Constants are kept zero-extended from their width in a `uint64_t` and
+// sign-extended on demand for signed operations.
+uint64_t truncate(uint64_t value, int width) {
+  return width == 64 ? value : value & ((uint64_t(1) << width) - 1);
+}
+
+int64_t extend(uint64_t value, int width) {
+  return static_cast<int64_t>(value << (64 - width)) >> (64 - width);
+}
+
+bool power_of_two(uint64_t value, uint64_t &shift) {
+  if (value < 2 || (value & (value - 1)) != 0)
+    return false;
+  shift = __builtin_ctzll(value);
+  return true;
+}
+
+// Computes `lhs op rhs` for operands of type `type`. Operations whose result
+// is undefined, like division by zero or shifting by the width or more, are
+// left for the program to perform at run time.
+bool fold(Operator op, enum Type type, uint64_t lhs, uint64_t rhs,
+          uint64_t &result) {
+  int bits = width(type);
+  bool is_signed = ast::is_signed(type);
+  int64_t slhs = extend(lhs, bits), srhs = extend(rhs, bits);
+
+  switch (op) {
+  case Add:
+    result = lhs + rhs;
+    break;
+  case Sub:
+    result = lhs - rhs;
+    break;
+  case Mul:
+    result = lhs * rhs;
+    break;
+  case Div:
+    if (rhs == 0)
+      return false;
+    if (is_signed) {
+      if (srhs == -1 && slhs == extend(uint64_t(1) << (bits - 1), bits))
+        return false;
+      result = slhs / srhs;
+    } else {
+      result = lhs / rhs;
+    }
+    break;
+  case Eq:
+    result = lhs == rhs;
+    break;
+  case Ne:
+    result = lhs != rhs;
+    break;
+  case Lt:
+    result = is_signed ? slhs < srhs : lhs < rhs;
+    break;
+  case Le:
+    result = is_signed ? slhs <= srhs : lhs <= rhs;
+    break;
+  case Gt:
+    result = is_signed ? slhs > srhs : lhs > rhs;
+    break;
+  case Ge:
+    result = is_signed ? slhs >= srhs : lhs >= rhs;
+    break;
+  case BitAnd:
+  case And:
+    result = lhs & rhs;
+    break;
+  case BitOr:
+  case Or:
+    result = lhs | rhs;
+    break;
+  case BitXor:
+    result = lhs ^ rhs;
+    break;
+  case Shl:
+    if (rhs >= static_cast<uint64_t>(bits))
+      return false;
+    result = lhs << rhs;
+    break;
+  case Shr:
+    if (rhs >= static_cast<uint64_t>(bits))
+      return false;
+    result = is_signed ? static_cast<uint64_t>(slhs >> rhs) : lhs >> rhs;
+    break;
+  default:
+    return false;
+  }
+  return true;
+}
+
+} // namespace
+
+Simplifier::Simplifier(Ast &ast, Interner &interner)
+    : ast(ast), interner(interner) {}
+
+void Simplifier::simplify() { simplify_children(this->ast.root); }
+
+void Simplifier::simplify_children(NodeId id) {
+  auto range = this->ast.ranges[id];
+  for (uint32_t i = 0; i < range.count; i++) {
+    auto child = this->ast.child_ids[range.first + i];
+    this->ast.child_ids[range.first + i] = simplify_expr(child);
+  }
+}
+
+NodeId Simplifier::simplify_expr(NodeId expr) {
+  simplify_children(expr);
+
+  switch (this->ast.kind(expr)) {
+  case BinaryExpr:
+    return simplify_binary(expr);
+  case UnaryExpr:
+    return simplify_unary(expr);
+  case Grouping:
+    return this->ast.child(expr, 0);
+  default:
+    return expr;
+  }
+}
+
+NodeId Simplifier::simplify_binary(NodeId expr) {
+  auto op = this->ast.op(expr);
+  auto lhs = this->ast.child(expr, 0);
+  auto rhs = this->ast.child(expr, 1);
+  auto type = this->ast.type(lhs);
+  if (op == Assign || width(type) == 0) {
+    return expr;
+  }
+
+  uint64_t left = 0, right = 0, shift = 0;
+  bool left_constant = constant(lhs, left);
+  bool right_constant = constant(rhs, right);
+
+  if (left_constant && right_constant) {
+    uint64_t result;
+    if (fold(op, type, left, right, result)) {
+      make_constant(expr, result);
+    }
+    return expr;
+  }
+
+  // A multiplication or unsigned division by 2^k becomes a shift by k; the
+  // constant operand is reused as the shift amount.
+  auto make_shift = [&](Operator shift_op, NodeId value, NodeId amount) {
+    auto first = this->ast.ranges[expr].first;
+    this->ast.ops[expr] = shift_op;
+    this->ast.child_ids[first] = value;
+    this->ast.child_ids[first + 1] = amount;
+    make_constant(amount, shift);
+    return expr;
+  };
+
+  switch (op) {
+  case Add:
+  case BitOr:
+  case BitXor:
+  case Or:
+    if (right_constant && right == 0)
+      return lhs;
+    if (left_constant && left == 0)
+      return rhs;
+    break;
+  case Sub:
+  case Shl:
+  case Shr:
+    if (right_constant && right == 0)
+      return lhs;
+    break;
+  case And:
+    if (right_constant && right == 1)
+      return lhs;
+    if (left_constant && left == 1)
+      return rhs;
+    break;
+  case Mul:
+    if (right_constant && right == 1)
+      return lhs;
+    if (left_constant && left == 1)
+      return rhs;
+    if (right_constant && power_of_two(right, shift))
+      return make_shift(Shl, lhs, rhs);
+    if (left_constant && power_of_two(left, shift))
+      return make_shift(Shl, rhs, lhs);
+    break;
+  case Div:
+    if (right_constant && right == 1)
+      return lhs;
+    // Signed division rounds towards zero, an arithmetic shift does not.
+    if (!is_signed(type) && right_constant && power_of_two(right, shift))
+      return make_shift(Shr, lhs, rhs);
+    break;
+  default:
+    break;
+  }
+  return expr;
+}
+
+NodeId Simplifier::simplify_unary(NodeId expr) {
+  auto op = this->ast.op(expr);
+  auto operand = this->ast.child(expr, 0);
+  if (width(this->ast.type(expr)) == 0) {
+    return expr;
+  }
+
+  uint64_t value;
+  if (constant(operand, value)) {
+    make_constant(expr, op == Negate ? 0 - value : ~value);
+    return expr;
+  }
+
+  // `-(-x)`, `!!x` and `~~x` are `x`.
+  if (this->ast.kind(operand) == UnaryExpr && this->ast.op(operand) == op) {
+    return this->ast.child(operand, 0);
+  }
+  return expr;
+}
+
+bool Simplifier::constant(NodeId id, uint64_t &value) const {
+  auto type = this->ast.type(id);
+  if (this->ast.kind(id) != Integer || width(type) == 0) {
+    return false;
+  }
+
+  // Folded negative constants are written with a sign.
+  std::string text(this->ast.name(id));
+  errno = 0;
+  value = text[0] == '-' ? std::strtoll(text.c_str(), nullptr, 10)
+                         : std::strtoull(text.c_str(), nullptr, 10);
+  if (errno == ERANGE) {
+    return false;
+  }
+  value = truncate(value, width(type));
+  return true;
+}
+
+// Turns `id` into a literal of its own type holding `value`. Its children,
+// if any, are left unreachable.
+void Simplifier::make_constant(NodeId id, uint64_t value) {
+  auto type = this->ast.type(id);
+  int bits = width(type);
+  value = truncate(value, bits);
+  auto text = is_signed(type) ? std::to_string(extend(value, bits))
+                              : std::to_string(value);
+
+  this->ast.kinds[id] = Integer;
+  this->ast.ops[id] = NoOp;
+  this->ast.symbols[id] = this->interner.intern(text);
+  this->ast.ranges[id] = ChildRange{0, 0};
+}
+
+} // namespace ast
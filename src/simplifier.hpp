@@ -0,0 +1,37 @@
+#ifndef SIMPLIFIER_H_
+#define SIMPLIFIER_H_
+
+#include "ast.hpp"
+#include "interner.hpp"
+#include <cstdint>
+
+namespace ast {
+
+// Rewrites a type-checked program in place before code generation: constant
+// subtrees are folded into literals, identities such as `x + 0` and `x * 1`
+// are dropped and multiplications by a power of two become shifts. Folding
+// wraps at the width of each node's type and honours its signedness, so the
+// result is the value the generated code would have computed.
+class Simplifier {
+public:
+  // New literals are interned in `interner`, the one `ast` was parsed with.
+  Simplifier(Ast &ast, Interner &interner);
+  void simplify();
+
+private:
+  void simplify_children(NodeId id);
+  // Returns the node that replaces `expr` in its parent.
+  NodeId simplify_expr(NodeId expr);
+  NodeId simplify_binary(NodeId expr);
+  NodeId simplify_unary(NodeId expr);
+
+  bool constant(NodeId id, uint64_t &value) const;
+  void make_constant(NodeId id, uint64_t value);
+
+  Ast &ast;
+  Interner &interner;
+};
+
+} // namespace ast
+
+#endif // SIMPLIFIER_H_
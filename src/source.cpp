@@ -0,0 +1,58 @@
+#include "source.hpp"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+SourceFile::SourceFile(const std::string &path) : filename(path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw CompileError(std::string("Could not open file: ") +
+                       std::strerror(errno));
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) < 0) {
+    int error = errno;
+    close(fd);
+    throw CompileError(std::string("Could not stat file: ") +
+                       std::strerror(error));
+  }
+
+  // mmap rejects empty mappings, an empty file is just an empty view.
+  this->size = st.st_size;
+  if (this->size > 0) {
+    this->data = mmap(nullptr, this->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (this->data == MAP_FAILED) {
+      int error = errno;
+      close(fd);
+      throw CompileError(std::string("Could not map file: ") +
+                         std::strerror(error));
+    }
+    // The lexer reads front to back exactly once.
+    madvise(this->data, this->size, MADV_SEQUENTIAL);
+  }
+
+  close(fd);
+}
+
+SourceFile::~SourceFile() {
+  if (this->data) {
+    munmap(this->data, this->size);
+  }
+}
+
+Location locate(std::string_view source, const char *at) {
+  Location location{1, 1};
+  for (const char *s = source.data(); s < at; s++) {
+    if (*s == '\n') {
+      location.line++;
+      location.column = 1;
+    } else {
+      location.column++;
+    }
+  }
+  return location;
+}
@@ -0,0 +1,47 @@
+#ifndef SOURCE_H_
+#define SOURCE_H_
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+// Read-only memory mapping of a source file. Every stage borrows `text()`
+// instead of copying the file, so the mapping has to outlive the compilation
+// of the file.
+class SourceFile {
+public:
+  explicit SourceFile(const std::string &path);
+  ~SourceFile();
+  SourceFile(const SourceFile &) = delete;
+  SourceFile &operator=(const SourceFile &) = delete;
+
+  std::string_view text() const {
+    return std::string_view(static_cast<const char *>(this->data),
+                            this->size);
+  }
+  const std::string &path() const { return this->filename; }
+
+private:
+  std::string filename;
+  void *data = nullptr;
+  size_t size = 0;
+};
+
+// 1-based line and column of `at` within `source`.
+struct Location {
+  int line;
+  int column;
+};
+
+Location locate(std::string_view source, const char *at);
+
+// A diagnostic about one source file, such as a lexing, parsing or type
+// error. Stages throw it instead of exiting so that the driver can report
+// which file of a batch failed while the other files keep compiling.
+class CompileError : public std::runtime_error {
+public:
+  using std::runtime_error::runtime_error;
+};
+
+#endif // SOURCE_H_
@@ -0,0 +1,78 @@
+#ifndef SYMBOLS_H_
+#define SYMBOLS_H_
+
+#include <cstddef>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Scoped symbol table with O(1) hashed lookup. Every binding is appended to
+// `entries` and remembers the binding it shadows, so leaving a scope just
+// pops its entries and restores whatever they were hiding.
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class SymbolTable {
+public:
+  SymbolTable() { push_scope(); }
+
+  void push_scope() { this->scopes.push_back(this->entries.size()); }
+
+  void pop_scope() {
+    size_t mark = this->scopes.back();
+    this->scopes.pop_back();
+    while (this->entries.size() > mark) {
+      Entry &entry = this->entries.back();
+      if (entry.shadowed == npos) {
+        this->index.erase(entry.key);
+      } else {
+        this->index[entry.key] = entry.shadowed;
+      }
+      this->entries.pop_back();
+    }
+  }
+
+  // Binds `key` in the innermost scope, shadowing any outer binding.
+  Value &insert(const Key &key, Value value) {
+    size_t shadowed = npos;
+    auto it = this->index.find(key);
+    if (it != this->index.end()) {
+      shadowed = it->second;
+      it->second = this->entries.size();
+    } else {
+      this->index.emplace(key, this->entries.size());
+    }
+    this->entries.push_back(Entry{key, std::move(value), shadowed});
+    return this->entries.back().value;
+  }
+
+  // Returns the innermost binding of `key`, or nullptr.
+  Value *lookup(const Key &key) {
+    auto it = this->index.find(key);
+    if (it == this->index.end())
+      return nullptr;
+    return &this->entries[it->second].value;
+  }
+
+  // True if `key` is bound in the innermost scope itself.
+  bool declared_in_scope(const Key &key) const {
+    auto it = this->index.find(key);
+    return it != this->index.end() && it->second >= this->scopes.back();
+  }
+
+  size_t depth() const { return this->scopes.size(); }
+
+private:
+  static constexpr size_t npos = static_cast<size_t>(-1);
+
+  struct Entry {
+    Key key;
+    Value value;
+    size_t shadowed;
+  };
+
+  std::vector<Entry> entries;
+  std::unordered_map<Key, size_t, Hash> index;
+  std::vector<size_t> scopes;
+};
+
+#endif // SYMBOLS_H_
@@ -0,0 +1,138 @@
+#include "target.hpp"
+#include <llvm/ADT/Optional.h>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/MC/TargetRegistry.h>
+#include <llvm/Support/Host.h>
+#include <llvm/Support/TargetSelect.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Target/TargetOptions.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+llvm::CodeGenOpt::Level codegen_level(OptLevel level) {
+  switch (level) {
+  case OptLevel::O0:
+    return llvm::CodeGenOpt::None;
+  case OptLevel::O1:
+    return llvm::CodeGenOpt::Less;
+  case OptLevel::O3:
+    return llvm::CodeGenOpt::Aggressive;
+  default:
+    return llvm::CodeGenOpt::Default;
+  }
+}
+
+namespace {
+
+Target create_target(const CompileOptions &options) {
+  Target result;
+  result.triple = llvm::sys::getDefaultTargetTriple();
+  result.level = codegen_level(options.opt_level);
+
+  std::string error;
+  result.target = llvm::TargetRegistry::lookupTarget(result.triple, error);
+
+  if (!result.target) {
+    llvm::errs() << error;
+    exit(1);
+  }
+
+  result.cpu = "generic";
+  std::vector<std::string> features;
+  if (options.native) {
+    result.cpu = llvm::sys::getHostCPUName().str();
+    llvm::StringMap<bool> host_features;
+    if (llvm::sys::getHostCPUFeatures(host_features)) {
+      for (auto &feature : host_features) {
+        features.push_back((feature.second ? "+" : "-") +
+                           feature.first().str());
+      }
+      // StringMap order is unspecified, keep the attribute stable.
+      std::sort(features.begin(), features.end());
+    }
+  }
+  if (!options.cpu.empty()) {
+    result.cpu = options.cpu;
+  }
+  // Later entries win, so explicit features override the host ones.
+  if (!options.features.empty()) {
+    features.push_back(options.features);
+  }
+  result.features = llvm::join(features, ",");
+  return result;
+}
+
+std::unique_ptr<llvm::TargetMachine> create_machine(const Target &target) {
+  llvm::TargetOptions opt;
+  auto rm = llvm::Optional<llvm::Reloc::Model>();
+  return std::unique_ptr<llvm::TargetMachine>(
+      target.target->createTargetMachine(target.triple, target.cpu,
+                                         target.features, opt, rm, llvm::None,
+                                         target.level));
+}
+
+std::mutex spare_mutex;
+std::map<const Target *, std::vector<std::unique_ptr<llvm::TargetMachine>>>
+    spare_machines;
+
+} // namespace
+
+const Target &resolve_target(const CompileOptions &options) {
+  static std::once_flag initialized;
+  std::call_once(initialized, [] {
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+    llvm::InitializeNativeTargetAsmParser();
+  });
+
+  using Key = std::tuple<bool, std::string, std::string, OptLevel>;
+  static std::mutex mutex;
+  // Node-based, so references stay valid as more targets are added.
+  static std::map<Key, Target> targets;
+
+  Key key{options.native, options.cpu, options.features, options.opt_level};
+  std::lock_guard<std::mutex> lock(mutex);
+  auto found = targets.find(key);
+  if (found == targets.end()) {
+    found = targets.emplace(key, create_target(options)).first;
+  }
+  return found->second;
+}
+
+llvm::TargetMachine &target_machine(const Target &target) {
+  thread_local std::map<const Target *, std::unique_ptr<llvm::TargetMachine>>
+      machines;
+
+  auto &machine = machines[&target];
+  if (!machine) {
+    std::lock_guard<std::mutex> lock(spare_mutex);
+    auto &spares = spare_machines[&target];
+    if (!spares.empty()) {
+      machine = std::move(spares.back());
+      spares.pop_back();
+    }
+  }
+  if (!machine) {
+    machine = create_machine(target);
+  }
+  return *machine;
+}
+
+void warm_target_machines(const Target &target, unsigned count) {
+  std::vector<std::unique_ptr<llvm::TargetMachine>> created;
+  for (unsigned i = 0; i < count; i++) {
+    created.push_back(create_machine(target));
+  }
+  std::lock_guard<std::mutex> lock(spare_mutex);
+  auto &spares = spare_machines[&target];
+  for (auto &machine : created) {
+    spares.push_back(std::move(machine));
+  }
+}
@@ -0,0 +1,37 @@
+#ifndef TARGET_H_
+#define TARGET_H_
+
+#include "options.hpp"
+#include <llvm/Support/CodeGen.h>
+#include <llvm/Target/TargetMachine.h>
+#include <string>
+
+// Code generation target resolved from the command line options: the host
+// triple plus the CPU and feature string that `-march`, `-mcpu` and `-mattr`
+// select.
+struct Target {
+  const llvm::Target *target;
+  std::string triple;
+  std::string cpu;
+  std::string features;
+  llvm::CodeGenOpt::Level level;
+};
+
+llvm::CodeGenOpt::Level codegen_level(OptLevel level);
+
+// Initializes LLVM's native target once per process and resolves `options`.
+// Results are cached, so every job of a batch with the same flags shares one
+// `Target` and queries the host only once.
+const Target &resolve_target(const CompileOptions &options);
+
+// Target machine for `target` owned by the calling thread. A target machine
+// must not be used by two threads at once, but one thread can reuse it for
+// any number of modules, so workers keep theirs across jobs.
+llvm::TargetMachine &target_machine(const Target &target);
+
+// Creates `count` target machines for `target` ahead of time. Each of the
+// next `count` threads that asks for one takes a prepared machine instead of
+// building its own; the compile server warms one per worker before forking.
+void warm_target_machines(const Target &target, unsigned count);
+
+#endif // TARGET_H_
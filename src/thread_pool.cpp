@@ -0,0 +1,118 @@
+#include "thread_pool.hpp"
+#include <utility>
+
+namespace {
+
+// Queue owned by the current thread, if it is one of a pool's workers.
+thread_local const ThreadPool *current_pool = nullptr;
+thread_local size_t current_queue = 0;
+
+} // namespace
+
+// Queue 0 belongs to threads outside the pool, workers own the rest.
+ThreadPool::ThreadPool(unsigned workers) {
+  for (unsigned i = 0; i <= workers; i++) {
+    this->queues.push_back(std::make_unique<Queue>());
+  }
+  for (unsigned i = 1; i <= workers; i++) {
+    this->workers.emplace_back([this, i] { work(i); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(this->sleep_mutex);
+    this->stopping = true;
+  }
+  this->wake.notify_all();
+  for (auto &worker : this->workers) {
+    worker.join();
+  }
+}
+
+unsigned ThreadPool::concurrency(unsigned jobs) {
+  if (jobs > 0)
+    return jobs;
+  unsigned threads = std::thread::hardware_concurrency();
+  return threads > 0 ? threads : 1;
+}
+
+void ThreadPool::submit(TaskGroup &group, std::function<void()> task) {
+  group.pending++;
+  size_t index = current_pool == this ? current_queue : 0;
+  {
+    // Counted before the task is published, so a thief that takes it right
+    // away never brings the count below zero. Pairs with the check in
+    // `work`, so a worker about to sleep sees it.
+    std::lock_guard<std::mutex> lock(this->sleep_mutex);
+    this->queued++;
+  }
+  {
+    std::lock_guard<std::mutex> lock(this->queues[index]->mutex);
+    this->queues[index]->tasks.push_back({std::move(task), &group});
+  }
+  this->wake.notify_one();
+}
+
+bool ThreadPool::pop(size_t index, bool back, Task &task) {
+  Queue &queue = *this->queues[index];
+  std::lock_guard<std::mutex> lock(queue.mutex);
+  if (queue.tasks.empty())
+    return false;
+  if (back) {
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+  } else {
+    task = std::move(queue.tasks.front());
+    queue.tasks.pop_front();
+  }
+  return true;
+}
+
+// Runs the newest task of the `home` queue, or steals the oldest task of
+// another one.
+bool ThreadPool::run_one(size_t home) {
+  Task task;
+  bool found = pop(home, true, task);
+  for (size_t i = 1; !found && i < this->queues.size(); i++) {
+    found = pop((home + i) % this->queues.size(), false, task);
+  }
+  if (!found)
+    return false;
+
+  this->queued--;
+  task.run();
+  task.group->pending--;
+  // Wakes threads waiting on the group as well as idle workers.
+  {
+    std::lock_guard<std::mutex> lock(this->sleep_mutex);
+  }
+  this->wake.notify_all();
+  return true;
+}
+
+void ThreadPool::wait(TaskGroup &group) {
+  size_t home = current_pool == this ? current_queue : 0;
+  while (!group.done()) {
+    if (run_one(home))
+      continue;
+    // Everything left is running on other threads.
+    std::unique_lock<std::mutex> lock(this->sleep_mutex);
+    this->wake.wait(lock,
+                    [&] { return group.done() || this->queued.load() > 0; });
+  }
+}
+
+void ThreadPool::work(size_t index) {
+  current_pool = this;
+  current_queue = index;
+  for (;;) {
+    if (run_one(index))
+      continue;
+    std::unique_lock<std::mutex> lock(this->sleep_mutex);
+    this->wake.wait(
+        lock, [this] { return this->stopping || this->queued.load() > 0; });
+    if (this->stopping && this->queued.load() == 0)
+      return;
+  }
+}
@@ -0,0 +1,70 @@
+#ifndef THREAD_POOL_H_
+#define THREAD_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Tasks whose completion can be waited on together.
+class TaskGroup {
+public:
+  bool done() const { return this->pending.load() == 0; }
+
+private:
+  friend class ThreadPool;
+  std::atomic<size_t> pending{0};
+};
+
+// Bounded work-stealing pool. Every worker has its own deque: tasks it
+// submits go to the back and it takes work from the back, while idle workers
+// steal from the front of the others. Waiting on a group runs queued tasks
+// instead of blocking, so tasks may submit and wait on nested work (a file's
+// functions inside a batch of files) without tying up a thread. With no
+// workers every task runs on the thread that waits for it.
+class ThreadPool {
+public:
+  // Starts `workers` threads; the thread calling `wait` is one more.
+  explicit ThreadPool(unsigned workers);
+  ~ThreadPool();
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  void submit(TaskGroup &group, std::function<void()> task);
+  // Runs tasks until every task submitted to `group` has finished.
+  void wait(TaskGroup &group);
+
+  // Threads running tasks, counting the one that waits.
+  size_t size() const { return this->workers.size() + 1; }
+
+  // Thread count for `jobs`, where 0 means one per hardware thread.
+  static unsigned concurrency(unsigned jobs);
+
+private:
+  struct Task {
+    std::function<void()> run;
+    TaskGroup *group;
+  };
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  void work(size_t index);
+  bool run_one(size_t home);
+  bool pop(size_t index, bool back, Task &task);
+
+  std::vector<std::unique_ptr<Queue>> queues;
+  std::vector<std::thread> workers;
+  std::atomic<size_t> queued{0};
+  std::mutex sleep_mutex;
+  std::condition_variable wake;
+  bool stopping = false;
+};
+
+#endif // THREAD_POOL_H_
@@ -0,0 +1,166 @@
+#include "timing.hpp"
+#include <llvm/IR/PassInstrumentation.h>
+#include <llvm/IR/PassTimingInfo.h>
+#include <llvm/Pass.h>
+#include <llvm/Support/Timer.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <iomanip>
+#include <new>
+#include <string>
+#include <sys/resource.h>
+
+namespace {
+
+thread_local uint64_t allocations = 0;
+thread_local uint64_t allocated_bytes = 0;
+
+const char *phase_names[phase_count] = {
+    "lex", "parse", "check", "simplify", "irgen", "optimize", "codegen", "link"};
+
+double wall_ms() {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+double thread_cpu_ms() {
+  timespec now;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+  return now.tv_sec * 1e3 + now.tv_nsec / 1e6;
+}
+
+long peak_rss_kb() {
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+} // namespace
+
+// Counting allocations needs the global operator. Everything still ends up
+// in malloc, so memory from the library's own variants can be freed here.
+void *operator new(size_t size) {
+  allocations++;
+  allocated_bytes += size;
+  if (void *memory = malloc(size ? size : 1))
+    return memory;
+  throw std::bad_alloc();
+}
+
+void *operator new[](size_t size) { return ::operator new(size); }
+
+void operator delete(void *memory) noexcept { free(memory); }
+void operator delete[](void *memory) noexcept { free(memory); }
+void operator delete(void *memory, size_t) noexcept { free(memory); }
+void operator delete[](void *memory, size_t) noexcept { free(memory); }
+
+bool TimeReport::active = false;
+std::mutex TimeReport::mutex;
+std::array<TimeReport::Totals, phase_count> TimeReport::phases;
+std::unique_ptr<llvm::TimePassesHandler> TimeReport::passes;
+
+void TimeReport::enable() {
+  active = true;
+  // Times the legacy pass manager that runs code generation.
+  llvm::TimePassesIsEnabled = true;
+  passes = std::make_unique<llvm::TimePassesHandler>(true);
+}
+
+void TimeReport::instrument(llvm::PassInstrumentationCallbacks &callbacks) {
+  if (active) {
+    passes->registerCallbacks(callbacks);
+  }
+}
+
+void TimeReport::record(Phase phase, double wall_ms, double cpu_ms,
+                        uint64_t allocations, uint64_t bytes,
+                        long peak_rss_kb) {
+  std::lock_guard<std::mutex> lock(mutex);
+  Totals &totals = phases[static_cast<size_t>(phase)];
+  totals.wall_ms += wall_ms;
+  totals.cpu_ms += cpu_ms;
+  totals.allocations += allocations;
+  totals.bytes += bytes;
+  totals.peak_rss_kb = std::max(totals.peak_rss_kb, peak_rss_kb);
+}
+
+void TimeReport::print(std::ostream &out, Format format) {
+  std::lock_guard<std::mutex> lock(mutex);
+  Totals total;
+  for (auto &phase : phases) {
+    total.wall_ms += phase.wall_ms;
+    total.cpu_ms += phase.cpu_ms;
+    total.allocations += phase.allocations;
+    total.bytes += phase.bytes;
+    total.peak_rss_kb = std::max(total.peak_rss_kb, phase.peak_rss_kb);
+  }
+
+  if (format == Format::Json) {
+    out << "{\n  \"phases\": {";
+    for (size_t i = 0; i <= phase_count; i++) {
+      const Totals &t = i < phase_count ? phases[i] : total;
+      out << (i ? "," : "") << "\n    \""
+          << (i < phase_count ? phase_names[i] : "total") << "\": {"
+          << "\"wall_ms\": " << t.wall_ms << ", \"cpu_ms\": " << t.cpu_ms
+          << ", \"allocations\": " << t.allocations
+          << ", \"allocated_bytes\": " << t.bytes
+          << ", \"peak_rss_kb\": " << t.peak_rss_kb << "}";
+    }
+    std::string values;
+    llvm::raw_string_ostream stream(values);
+    llvm::TimerGroup::printAllJSONValues(stream, "");
+    llvm::TimerGroup::clearAll();
+    out << "\n  },\n  \"llvm\": {" << stream.str() << "\n  }\n}"
+        << std::endl;
+  } else {
+    out << "===" << std::string(70, '-') << "===\n"
+        << "                        brom compilation time report\n"
+        << "===" << std::string(70, '-') << "===\n";
+    out << std::left << std::setw(10) << "phase" << std::right
+        << std::setw(12) << "wall (ms)" << std::setw(12) << "cpu (ms)"
+        << std::setw(12) << "allocs" << std::setw(14) << "alloc bytes"
+        << std::setw(14) << "peak RSS (KB)" << "\n";
+    out << std::fixed << std::setprecision(3);
+    for (size_t i = 0; i <= phase_count; i++) {
+      const Totals &t = i < phase_count ? phases[i] : total;
+      out << std::left << std::setw(10)
+          << (i < phase_count ? phase_names[i] : "total") << std::right
+          << std::setw(12) << t.wall_ms << std::setw(12) << t.cpu_ms
+          << std::setw(12) << t.allocations << std::setw(14) << t.bytes
+          << std::setw(14) << t.peak_rss_kb << "\n";
+    }
+    out << std::endl;
+
+    std::string timings;
+    llvm::raw_string_ostream stream(timings);
+    passes->setOutStream(stream);
+    passes->print();
+    llvm::reportAndResetTimings(&stream);
+    out << stream.str() << std::flush;
+  }
+  passes.reset();
+}
+
+PhaseTimer::PhaseTimer(Phase phase)
+    : phase(phase), active(TimeReport::enabled()) {
+  if (this->active) {
+    this->wall_start = wall_ms();
+    this->cpu_start = thread_cpu_ms();
+    this->allocations_start = allocations;
+    this->bytes_start = allocated_bytes;
+  }
+}
+
+PhaseTimer::~PhaseTimer() {
+  if (this->active) {
+    TimeReport::record(this->phase, wall_ms() - this->wall_start,
+                       thread_cpu_ms() - this->cpu_start,
+                       allocations - this->allocations_start,
+                       allocated_bytes - this->bytes_start, peak_rss_kb());
+  }
+}
@@ -0,0 +1,81 @@
+#ifndef TIMING_H_
+#define TIMING_H_
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+
+namespace llvm {
+class PassInstrumentationCallbacks;
+class TimePassesHandler;
+} // namespace llvm
+
+// Where `--time-report` attributes the time of a compilation.
+enum class Phase {
+  Lex,
+  Parse,
+  Check,
+  Simplify,
+  IRGen,
+  Optimize,
+  Codegen,
+  Link
+};
+constexpr size_t phase_count = 8;
+
+// Process-wide totals for every phase, in the spirit of `-ftime-report`.
+// Phases are timed by `PhaseTimer` scopes, which cost nothing while the
+// report is disabled. Allocations are counted per thread by the global
+// `operator new`, so a scope only sees what its own thread allocated.
+class TimeReport {
+public:
+  enum class Format { Text, Json };
+
+  static void enable();
+  static bool enabled() { return active; }
+
+  // Records LLVM's optimization passes in the report.
+  static void instrument(llvm::PassInstrumentationCallbacks &callbacks);
+
+  static void record(Phase phase, double wall_ms, double cpu_ms,
+                     uint64_t allocations, uint64_t bytes, long peak_rss_kb);
+
+  // Prints the phases followed by LLVM's pass timings.
+  static void print(std::ostream &out, Format format);
+
+private:
+  struct Totals {
+    double wall_ms = 0;
+    double cpu_ms = 0;
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+    long peak_rss_kb = 0;
+  };
+
+  static bool active;
+  static std::mutex mutex;
+  static std::array<Totals, phase_count> phases;
+  static std::unique_ptr<llvm::TimePassesHandler> passes;
+};
+
+// Adds the time and allocations between construction and destruction to
+// `phase`.
+class PhaseTimer {
+public:
+  explicit PhaseTimer(Phase phase);
+  ~PhaseTimer();
+  PhaseTimer(const PhaseTimer &) = delete;
+  PhaseTimer &operator=(const PhaseTimer &) = delete;
+
+private:
+  Phase phase;
+  bool active;
+  double wall_start;
+  double cpu_start;
+  uint64_t allocations_start;
+  uint64_t bytes_start;
+};
+
+#endif // TIMING_H_
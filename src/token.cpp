@@ -2,10 +2,10 @@
 
 namespace tokenizer {
 
-Token::Token(TokenType type, std::string lexeme) : type(type), lexeme(lexeme){};
+Token::Token(TokenType type, std::string_view lexeme, Symbol symbol,
+             Keyword keyword)
+    : type(type), keyword(keyword), lexeme(lexeme), symbol(symbol){};
 
-Token *Token::get_next() { return this->next; }
-
-bool Token::is(TokenType type) { return this->type == type; }
+bool Token::is(TokenType type) const { return this->type == type; }
 
 } // namespace tokenizer
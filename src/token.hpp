@@ -1,7 +1,9 @@
 #ifndef TOKEN_H_
 #define TOKEN_H_
 
-#include <string>
+#include "interner.hpp"
+#include "keywords.hpp"
+#include <string_view>
 
 namespace tokenizer {
 
@@ -25,17 +27,41 @@ enum TokenType {
   Ret,
   RightArrow,
   Colon,
-  Comma
+  Comma,
+  Bang,
+  Tilde,
+  Amp,
+  AmpAmp,
+  Pipe,
+  PipePipe,
+  Caret,
+  Less,
+  LessEqual,
+  LessLess,
+  Greater,
+  GreaterEqual,
+  GreaterGreater,
+  EqualEqual,
+  BangEqual,
+  FloatLiteral,
+  Pub
 };
 
+constexpr int token_type_count = Pub + 1;
+
+// Tokens are stored by value in a flat array owned by the lexer. The lexeme
+// is a view into the source buffer, which must outlive the token array.
+// Identifiers and literals also carry their interned symbol, keywords and
+// type names the keyword they spell.
 class Token {
 public:
-  std::string lexeme;
-  bool is(TokenType type);
-  Token *get_next();
-  Token(TokenType type, std::string lexeme);
-  Token *next;
+  Token(TokenType type, std::string_view lexeme, Symbol symbol = NoSymbol,
+        Keyword keyword = Keyword::None);
+  bool is(TokenType type) const;
   TokenType type;
+  Keyword keyword;
+  std::string_view lexeme;
+  Symbol symbol;
 };
 
 } // namespace tokenizer
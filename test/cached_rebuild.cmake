@@ -0,0 +1,53 @@
+# Rebuilds a program with the object cache after editing a function that
+# calls a private function whose object is already cached. Private callees
+# of re-emitted functions used to be declared with internal linkage, which
+# the IR verifier rejects.
+#
+# cmake -DBROM=<brom> -DCXX=<compiler> -DWORK_DIR=<dir> -P cached_rebuild.cmake
+
+file(REMOVE_RECURSE ${WORK_DIR})
+file(MAKE_DIRECTORY ${WORK_DIR})
+
+function(build_and_run source expected)
+  file(WRITE ${WORK_DIR}/program.br "${source}")
+  execute_process(
+    COMMAND ${BROM} --cache-dir=${WORK_DIR}/cache -o ${WORK_DIR}/program.o
+            ${WORK_DIR}/program.br
+    RESULT_VARIABLE result)
+  if(NOT result EQUAL 0)
+    message(FATAL_ERROR "brom failed with ${result}")
+  endif()
+  execute_process(
+    COMMAND ${CXX} ${WORK_DIR}/program.o -o ${WORK_DIR}/program
+    RESULT_VARIABLE result)
+  if(NOT result EQUAL 0)
+    message(FATAL_ERROR "linking failed with ${result}")
+  endif()
+  execute_process(COMMAND ${WORK_DIR}/program RESULT_VARIABLE result)
+  if(NOT result EQUAL expected)
+    message(FATAL_ERROR "program returned ${result}, expected ${expected}")
+  endif()
+endfunction()
+
+set(helper "fn helper(x: i32) -> i32 {\n  ret x * 3;\n}\n")
+
+build_and_run("${helper}
+fn twice(x: i32) -> i32 {
+  ret helper(x) + helper(x);
+}
+
+fn main() -> i32 {
+  ret twice(2);
+}
+" 12)
+
+# `twice` and `main` change, `helper` comes from the cache.
+build_and_run("${helper}
+fn twice(x: i32) -> i32 {
+  ret helper(x) + helper(x) + 1;
+}
+
+fn main() -> i32 {
+  ret twice(2) + helper(1);
+}
+" 16)